@@ -16,6 +16,18 @@
 #include "ns3/csma-module.h"
 #include "ns3/netanim-module.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/traffic-control-module.h"
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -23,66 +35,522 @@ using namespace ns3;
 
 /**
  * @brief The test cases include:
- * 1. P2P network with 1 server and 1 client
- * 2. Wireless network with 1 server and 1 clients
+ * 1. P2P star with 1 server and one link per client node
+ * 2. Wireless network with 1 server on the AP and client STAs contending for it
+ * 3. CSMA segment with 1 server and many clients, unicast or multicast
+ * 4. P2P tree: the server feeds --clusters routers, each router a cluster
+ *    of client nodes
+ *
+ * --receivers sets the number of client nodes and --clientsPerNode the
+ * number of clients on each of them. The byte counters of the client
+ * side only count the first client node.
+ *
+ * With --mpi (ns-3 configured with --enable-mpi) cases 1 and 4 run on the
+ * distributed simulator: the server stays on rank 0 and the client nodes,
+ * or the clusters with their routers, are spread over the other ranks in
+ * contiguous blocks, so only p2p links cross ranks. Every rank builds the
+ * same topology in the same order and only runs its own applications; the
+ * counters and --stats rows are collected on rank 0.
  */
 
 NS_LOG_COMPONENT_DEFINE("VideoStreamTest");
 
+static uint32_t g_queueDrops = 0; //!< Packets dropped by device queues and queue discs
+static uint64_t g_clientRxBytes = 0; //!< Bytes received by the client device
+static uint64_t g_serverTxBytes = 0; //!< Bytes sent by the server device
+static uint64_t g_multicastRetrans = 0; //!< Retransmissions sent once to the whole group
+static uint64_t g_unicastRetrans = 0; //!< Retransmissions of the group sent to a single receiver
+static std::map<Address, uint64_t> g_congestionRates; //!< Last congestion controlled rate of each client
+static uint64_t g_expiredRetrans = 0; //!< Retransmissions the server skipped after their deadline
+static uint64_t g_fecRecovered = 0; //!< Lost packets the client recovered from parity packets
+static uint64_t g_droppedFrames = 0; //!< Frames the server dropped because of a long backlog
+static uint64_t g_undecodableFrames = 0; //!< Complete frames the clients played without their reference frame
+static uint64_t g_clientsLeft = 0;     //!< Clients the server removed after their bye
+static uint64_t g_clientsTimedOut = 0; //!< Clients the server removed after a timeout
+static uint32_t g_rank = 0;  //!< Rank of this process in a distributed simulation
+static uint32_t g_ranks = 1; //!< Number of ranks of a distributed simulation
+
+static void
+DeviceQueueDrop(Ptr<const Packet> packet)
+{
+  g_queueDrops++;
+}
+
+static void
+QueueDiscDrop(Ptr<const QueueDiscItem> item)
+{
+  g_queueDrops++;
+}
+
+static void
+ExpiredRetrans(uint64_t oldValue, uint64_t newValue)
+{
+  g_expiredRetrans = newValue;
+}
+
+static void
+FecRecovered(uint64_t oldValue, uint64_t newValue)
+{
+  g_fecRecovered = newValue;
+}
+
+static void
+DroppedFrames(uint64_t oldValue, uint64_t newValue)
+{
+  g_droppedFrames = newValue;
+}
+
+static void
+FrameUndecodable(uint32_t frameNum)
+{
+  g_undecodableFrames++;
+}
+
+static void
+ClientRemoved(const Address &client, bool timedOut)
+{
+  if (timedOut)
+  {
+    g_clientsTimedOut++;
+  }
+  else
+  {
+    g_clientsLeft++;
+  }
+}
+
+static void
+MulticastRetrans(uint64_t oldValue, uint64_t newValue)
+{
+  g_multicastRetrans = newValue;
+}
+
+static void
+UnicastRetrans(uint64_t oldValue, uint64_t newValue)
+{
+  g_unicastRetrans = newValue;
+}
+
+static void
+CongestionRate(const Address &client, uint64_t rate)
+{
+  g_congestionRates[client] = rate;
+}
+
+static void
+ServerTx(Ptr<const Packet> packet)
+{
+  g_serverTxBytes += packet->GetSize();
+}
+
+static void
+ClientRx(Ptr<const Packet> packet)
+{
+  g_clientRxBytes += packet->GetSize();
+}
+
+/**
+ * @brief Count queue drops everywhere, bytes received by the client and bytes sent by the server.
+ *
+ * @param clientRxPath config path of the MacRx trace of the client device
+ * @param serverTxPath config path of the MacTx trace of the server device
+ */
+static void
+ConnectCounters(std::string clientRxPath, std::string serverTxPath)
+{
+  Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/Drop", MakeCallback(&DeviceQueueDrop));
+  Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/Txop/Queue/Drop", MakeCallback(&DeviceQueueDrop));
+  Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/BE_Txop/Queue/Drop", MakeCallback(&DeviceQueueDrop));
+  Config::ConnectWithoutContext("/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/Drop", MakeCallback(&QueueDiscDrop));
+  Config::ConnectWithoutContext(clientRxPath, MakeCallback(&ClientRx));
+  Config::ConnectWithoutContext(serverTxPath, MakeCallback(&ServerTx));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamServer/ExpiredRetransmissions", MakeCallback(&ExpiredRetrans));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamClient/FecRecovered", MakeCallback(&FecRecovered));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamServer/MulticastRetransmissions", MakeCallback(&MulticastRetrans));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamServer/UnicastRetransmissions", MakeCallback(&UnicastRetrans));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamServer/CongestionRate", MakeCallback(&CongestionRate));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamServer/DroppedFrames", MakeCallback(&DroppedFrames));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamClient/FrameUndecodable", MakeCallback(&FrameUndecodable));
+  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::VideoStreamServer/ClientRemoved", MakeCallback(&ClientRemoved));
+}
+
+/**
+ * @brief Drop a fraction of the packets received by a device.
+ */
+static void
+SetLoss(Ptr<NetDevice> device, double loss)
+{
+  if (loss > 0)
+  {
+    Ptr<RateErrorModel> errorModel = CreateObject<RateErrorModel>();
+    errorModel->SetAttribute("ErrorRate", DoubleValue(loss));
+    errorModel->SetAttribute("ErrorUnit", StringValue("ERROR_UNIT_PACKET"));
+    device->SetAttribute("ReceiveErrorModel", PointerValue(errorModel));
+  }
+}
+
+/**
+ * @brief Set the server attributes shared by every case.
+ */
+static void
+ConfigureServer(VideoStreamServerHelper &server, uint32_t pktPerFrame, std::string pacing, std::string abr,
+                std::string cc, std::string trace, bool priority, uint32_t dropBacklog)
+{
+  server.SetAttribute("PacketNum", UintegerValue(pktPerFrame));
+  server.SetAttribute("PacingMode", StringValue(pacing));
+  server.SetAttribute("AbrAlgorithm", StringValue(abr));
+  server.SetAttribute("CongestionControl", StringValue(cc));
+  server.SetAttribute("VideoTraceFile", StringValue(trace));
+  server.SetAttribute("FramePriority", BooleanValue(priority));
+  server.SetAttribute("DropBacklog", UintegerValue(dropBacklog));
+}
+
+/**
+ * @brief Select how losses are repaired: Arq (NACK only), Fec (parity only) or Hybrid (parity, then NACK).
+ */
+static void
+ConfigureRecovery(VideoStreamServerHelper &server, VideoStreamClientHelper &client, std::string recovery,
+                  std::string fec, uint32_t fecBlock, uint32_t fecParity)
+{
+  std::string fecMode = (recovery == "Arq") ? "None" : fec;
+  server.SetAttribute("FecMode", StringValue(fecMode));
+  server.SetAttribute("FecBlockSize", UintegerValue(fecBlock));
+  server.SetAttribute("FecParity", UintegerValue(fecParity));
+  client.SetAttribute("FecMode", StringValue(fecMode));
+  client.SetAttribute("FecBlockSize", UintegerValue(fecBlock));
+  client.SetAttribute("FecParity", UintegerValue(fecParity));
+  client.SetAttribute("EnableNack", BooleanValue(recovery != "Fec"));
+}
+
+/**
+ * @brief Get the rank a client node or cluster is simulated on.
+ *
+ * Rank 0 keeps the server alone, the others get contiguous blocks.
+ *
+ * @param i the index of the client node or cluster
+ * @param n the number of client nodes or clusters
+ */
+static uint32_t
+GetRank(uint32_t i, uint32_t n)
+{
+  if (g_ranks == 1)
+  {
+    return 0;
+  }
+  return 1 + i * (g_ranks - 1) / n;
+}
+
+/**
+ * @brief Sum the counters of all ranks on rank 0.
+ */
+static void
+ReduceCounters(void)
+{
+#ifdef NS3_MPI
+  if (g_ranks > 1)
+  {
+    uint64_t *counters[] = {&g_clientRxBytes, &g_serverTxBytes, &g_multicastRetrans, &g_unicastRetrans,
+                            &g_expiredRetrans, &g_fecRecovered, &g_droppedFrames, &g_undecodableFrames,
+                            &g_clientsLeft, &g_clientsTimedOut};
+    const int n = sizeof(counters) / sizeof(counters[0]);
+    unsigned long long local[n + 1];
+    unsigned long long total[n + 1];
+    for (int i = 0; i < n; i++)
+    {
+      local[i] = *counters[i];
+    }
+    local[n] = g_queueDrops;
+    MPI_Reduce(local, total, n + 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    for (int i = 0; i < n; i++)
+    {
+      *counters[i] = total[i];
+    }
+    g_queueDrops = total[n];
+  }
+#endif
+}
+
+/**
+ * @brief Write the QoE statistics of the clients of all ranks from rank 0.
+ */
+static void
+WriteStats(const VideoStreamStatsCollector &stats, std::string filename)
+{
+#ifdef NS3_MPI
+  if (g_ranks > 1)
+  {
+    // 랭크 순서가 클라이언트 순서이므로 각 랭크의 행을 이어 붙이면 단일 실행과 같은 파일이 된다
+    std::ostringstream rows;
+    stats.Write(rows, false);
+    std::string local = rows.str();
+    int size = local.size();
+    std::vector<int> sizes(g_ranks);
+    MPI_Gather(&size, 1, MPI_INT, &sizes[0], 1, MPI_INT, 0, MPI_COMM_WORLD);
+    std::vector<int> offsets(g_ranks, 0);
+    for (uint32_t r = 1; r < g_ranks; r++)
+    {
+      offsets[r] = offsets[r - 1] + sizes[r - 1];
+    }
+    std::string all(g_rank == 0 ? offsets[g_ranks - 1] + sizes[g_ranks - 1] : 0, '\0');
+    MPI_Gatherv(const_cast<char *>(local.data()), size, MPI_CHAR, g_rank == 0 ? &all[0] : 0, &sizes[0], &offsets[0], MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (g_rank == 0)
+    {
+      std::ofstream os(filename.c_str());
+      NS_ABORT_MSG_UNLESS(os.is_open(), "Cannot open " << filename);
+      os << VideoStreamStatsCollector::GetCsvHeader() << std::endl
+         << all;
+    }
+    return;
+  }
+#endif
+  stats.WriteFile(filename);
+}
+
+static void
+PrintCounters(double seconds)
+{
+  std::cout << "queue drops: " << g_queueDrops << std::endl;
+  std::cout << "client received: " << g_clientRxBytes << " bytes (" << g_clientRxBytes * 8 / seconds / 1e6 << " Mbps)" << std::endl;
+  std::cout << "server sent: " << g_serverTxBytes << " bytes (" << g_serverTxBytes * 8 / seconds / 1e6 << " Mbps)" << std::endl;
+  std::cout << "expired retransmissions skipped: " << g_expiredRetrans << std::endl;
+  std::cout << "packets recovered by FEC: " << g_fecRecovered << std::endl;
+  std::cout << "retransmissions multicast/unicast: " << g_multicastRetrans << "/" << g_unicastRetrans << std::endl;
+  std::cout << "frames dropped by the server: " << g_droppedFrames << std::endl;
+  std::cout << "frames undecodable at the clients: " << g_undecodableFrames << std::endl;
+  std::cout << "clients removed by the server after bye/timeout: " << g_clientsLeft << "/" << g_clientsTimedOut << std::endl;
+  if (!g_congestionRates.empty())
+  {
+    uint64_t total = 0;
+    for (auto iter = g_congestionRates.begin(); iter != g_congestionRates.end(); iter++)
+    {
+      total += iter->second;
+    }
+    std::cout << "congestion controlled rate: " << total / g_congestionRates.size() / 1e6 << " Mbps per client" << std::endl;
+  }
+}
+
+/**
+ * @brief Print the percentiles of the frame latencies of all clients.
+ */
+static void
+PrintLatency(const VideoStreamStatsCollector &stats)
+{
+  for (uint32_t stage = 0; stage < VideoStreamStatsCollector::LATENCY_STAGES; stage++)
+  {
+    VideoStreamStatsCollector::LatencyStage latencyStage = static_cast<VideoStreamStatsCollector::LatencyStage>(stage);
+    VideoStreamLatencyHistogram latency = stats.GetLatency(latencyStage);
+    std::cout << "frame latency " << VideoStreamStatsCollector::GetLatencyStageName(latencyStage) << ": p50 "
+              << latency.GetPercentile(50).GetSeconds() * 1000 << " ms, p90 " << latency.GetPercentile(90).GetSeconds() * 1000
+              << " ms, p99 " << latency.GetPercentile(99).GetSeconds() * 1000 << " ms, p99.9 " << latency.GetPercentile(99.9).GetSeconds() * 1000
+              << " ms (" << latency.GetCount() << " frames)" << std::endl;
+  }
+}
+
+/**
+ * @brief Run the simulation, print the counters and write the statistics.
+ *
+ * @param seconds the time the clients were running, over which the rates are averaged
+ */
+static void
+RunAndReport(const VideoStreamStatsCollector &stats, double seconds, std::string statsFile, std::string latencyFile)
+{
+  SystemWallClockMs clock;
+  clock.Start();
+  Simulator::Run();
+  int64_t wallMs = clock.End();
+  ReduceCounters();
+  if (g_rank == 0)
+  {
+    PrintCounters(seconds);
+    std::cout << "simulation wall-clock: " << wallMs << " ms on " << g_ranks << " rank(s)" << std::endl;
+  }
+  if (g_ranks == 1 && stats.GetN() > 0)
+  {
+    VideoStreamStatsCollector::Metrics mean = stats.GetMean();
+    std::cout << "time to first frame: " << mean.m_ttff << " s, startup delay: " << mean.m_startupDelay << " s (client mean)" << std::endl;
+    std::cout << "stalls: " << mean.m_stalls << ", stall time: " << mean.m_stallTime << " s, played at an adapted rate: "
+              << mean.m_adaptedRatio * 100 << "% (client mean)" << std::endl;
+    PrintLatency(stats);
+    if (!latencyFile.empty())
+    {
+      stats.WriteLatencyFile(latencyFile);
+    }
+  }
+  if (!statsFile.empty())
+  {
+    WriteStats(stats, statsFile);
+  }
+  Simulator::Destroy();
+}
+
 int main(int argc, char *argv[])
 {
   CommandLine cmd;
   uint32_t _case = 1;
   uint32_t _pktPerFrame = 100;
+  std::string _pacing = "Rate";
   cmd.AddValue("case", "which case?", _case);
   cmd.AddValue("pktPerFrame", "# of packets per frame", _pktPerFrame);
+  std::string _abr = "None";
+  cmd.AddValue("pacing", "server pacing mode (None, Rate, TokenBucket)", _pacing);
+  cmd.AddValue("abr", "adaptive bitrate algorithm (None, BufferBased, ThroughputBased)", _abr);
+  std::string _recovery = "Arq";
+  std::string _fec = "Xor";
+  uint32_t _fecBlock = 10;
+  uint32_t _fecParity = 2;
+  double _loss = 0.0;
+  cmd.AddValue("recovery", "loss recovery (Arq, Fec, Hybrid)", _recovery);
+  cmd.AddValue("fec", "FEC code of the Fec and Hybrid recovery (Xor, ReedSolomon)", _fec);
+  cmd.AddValue("fecBlock", "source packets per FEC block, 0 for the whole frame", _fecBlock);
+  cmd.AddValue("fecParity", "parity packets per block with ReedSolomon", _fecParity);
+  cmd.AddValue("loss", "packet loss rate on the client links (case 1, 3 and 4)", _loss);
+  std::string _linkRate = "";
+  std::string _linkDelay = "";
+  cmd.AddValue("linkRate", "data rate of the client links (case 1, 3 and 4), empty for 100Mbps p2p and 1Gbps CSMA", _linkRate);
+  cmd.AddValue("linkDelay", "delay of the client links (case 1, 3 and 4), empty for 2ms p2p and 50us CSMA", _linkDelay);
+  std::string _cc = "None";
+  cmd.AddValue("cc", "congestion control (None, Tfrc, DelayBased)", _cc);
+  uint32_t _receivers = 0;
+  uint32_t _clientsPerNode = 1;
+  bool _multicast = true;
+  cmd.AddValue("receivers", "number of client nodes (default 1 in case 1 and 2, 20 in case 3)", _receivers);
+  cmd.AddValue("clientsPerNode", "clients on each client node, sharing its address (unicast only)", _clientsPerNode);
+  cmd.AddValue("multicast", "send one multicast stream instead of one stream per client (case 3)", _multicast);
+  std::string _trace = "";
+  cmd.AddValue("trace", "video trace with one '<I|P|B> <bytes>' line per frame, fixed frames of pktPerFrame packets if empty", _trace);
+  bool _priority = false;
+  uint32_t _dropBacklog = 0;
+  cmd.AddValue("priority", "send and retransmit I frames before P and B frames", _priority);
+  cmd.AddValue("dropBacklog", "packets waiting for a client above which the server drops B frames, 0 never drops", _dropBacklog);
+  uint32_t _fastStart = 0;
+  double _fastStartSpeedup = 4.0;
+  uint32_t _fastStartPrimed = 0;
+  cmd.AddValue("fastStart", "initial frames the server sends faster than the frame interval, 0 to disable", _fastStart);
+  cmd.AddValue("fastStartSpeedup", "frame rate speedup during fast start", _fastStartSpeedup);
+  cmd.AddValue("fastStartPrimed", "buffered frames reported by a client that end its fast start, 0 to ignore reports", _fastStartPrimed);
+  std::string _initialDelay = "3s";
+  uint32_t _startThreshold = 1;
+  uint32_t _resumeThreshold = 20;
+  cmd.AddValue("initialDelay", "time from the client start before playout may begin", _initialDelay);
+  cmd.AddValue("startThreshold", "buffered frames needed to start playing", _startThreshold);
+  cmd.AddValue("resumeThreshold", "buffered frames needed to resume playing after a stall", _resumeThreshold);
+  bool _adaptivePlayout = false;
+  std::string _playoutLow = "1s";
+  std::string _playoutHigh = "3s";
+  cmd.AddValue("adaptivePlayout", "play slower while the client buffer is low and faster while it is high", _adaptivePlayout);
+  cmd.AddValue("playoutLow", "buffered playout time below which frames are played at 0.9x", _playoutLow);
+  cmd.AddValue("playoutHigh", "buffered playout time above which frames are played at 1.1x", _playoutHigh);
+  double _clientStop = 100.0;
+  cmd.AddValue("clientStop", "time the clients stop and say bye, the server stops at 100s", _clientStop);
+  std::string _stats = "";
+  cmd.AddValue("stats", "write the QoE statistics of the clients to this CSV file", _stats);
+  std::string _latency = "";
+  cmd.AddValue("latency", "write the frame latency percentiles of every client and of the run to this CSV file (single rank)", _latency);
+  bool _verbose = false;
+  cmd.AddValue("verbose", "log the stalls of the clients, and every played frame", _verbose);
+  bool _mpi = false;
+  uint32_t _clusters = 4;
+  cmd.AddValue("mpi", "run cases 1 and 4 on the distributed simulator (mpirun -np N)", _mpi);
+  cmd.AddValue("clusters", "number of router clusters of case 4", _clusters);
   cmd.Parse(argc, argv);
+  if (_mpi)
+  {
+#ifdef NS3_MPI
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    MpiInterface::Enable(&argc, &argv);
+    g_rank = MpiInterface::GetSystemId();
+    g_ranks = MpiInterface::GetSize();
+#else
+    NS_ABORT_MSG("--mpi needs ns-3 configured with --enable-mpi");
+#endif
+  }
+  NS_ABORT_MSG_IF(g_ranks > 1 && _case != 1 && _case != 4, "Only the p2p cases 1 and 4 can be distributed");
+  std::string _ccType = (_cc == "None") ? "" : "ns3::VideoStream" + _cc;
+  // Clients run from 1s until they stop or the server stops at 100s
+  double _clientWindow = std::max(std::min(_clientStop, 100.0) - 1.0, 1e-3);
+  if (_receivers == 0)
+  {
+    _receivers = (_case == 3) ? 20 : 1;
+  }
 
   Time::SetResolution(Time::NS);
-  LogComponentEnable("VideoStreamClientApplication", LOG_LEVEL_INFO);
+  Config::SetDefault("ns3::VideoStreamServer::FastStartFrames", UintegerValue(_fastStart));
+  Config::SetDefault("ns3::VideoStreamServer::FastStartSpeedup", DoubleValue(_fastStartSpeedup));
+  Config::SetDefault("ns3::VideoStreamServer::FastStartPrimedFrames", UintegerValue(_fastStartPrimed));
+  Config::SetDefault("ns3::VideoStreamClient::InitialDelay", TimeValue(Time(_initialDelay)));
+  Config::SetDefault("ns3::VideoStreamClient::StartThreshold", UintegerValue(_startThreshold));
+  Config::SetDefault("ns3::VideoStreamClient::ResumeThreshold", UintegerValue(_resumeThreshold));
+  Config::SetDefault("ns3::VideoStreamClient::ResumeThresholdTime", TimeValue(Seconds(0)));
+  Config::SetDefault("ns3::VideoStreamClient::AdaptivePlayout", BooleanValue(_adaptivePlayout));
+  Config::SetDefault("ns3::VideoStreamClient::PlayoutLowWatermark", TimeValue(Time(_playoutLow)));
+  Config::SetDefault("ns3::VideoStreamClient::PlayoutHighWatermark", TimeValue(Time(_playoutHigh)));
+  if (_verbose)
+  {
+    LogComponentEnable("VideoStreamClientApplication", LOG_LEVEL_LOGIC);
+  }
+  VideoStreamStatsCollector stats;
 
   if (_case == 1)
   {
-    NodeContainer nodes;
-    nodes.Create(2);
+    // Star: node 0 is the server, every client node has its own p2p link to it
+    NodeContainer serverNode;
+    serverNode.Create(1, 0);
+    NodeContainer clientNodes;
+    for (uint32_t i = 0; i < _receivers; i++)
+    {
+      clientNodes.Create(1, GetRank(i, _receivers));
+    }
 
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
-
-    NetDeviceContainer devices;
-    devices = pointToPoint.Install(nodes);
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(_linkRate.empty() ? "100Mbps" : _linkRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue(_linkDelay.empty() ? "2ms" : _linkDelay));
 
     InternetStackHelper stack;
-    stack.Install(nodes);
+    stack.Install(serverNode);
+    stack.Install(clientNodes);
 
     Ipv4AddressHelper address;
     address.SetBase("10.1.1.0", "255.255.255.0");
 
-    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+    VideoStreamServerHelper videoServer(5000);
+    ConfigureServer(videoServer, _pktPerFrame, _pacing, _abr, _ccType, _trace, _priority, _dropBacklog);
 
-    VideoStreamClientHelper videoClient(interfaces.GetAddress(0), 5000);
+    VideoStreamClientHelper videoClient(Ipv4Address::GetAny(), 5000);
     videoClient.SetAttribute("PacketNum", UintegerValue(_pktPerFrame));
-    ApplicationContainer clientApp = videoClient.Install(nodes.Get(1));
-    clientApp.Start(Seconds(1.0));
-    clientApp.Stop(Seconds(100.0));
-
-    VideoStreamServerHelper videoServer(5000);
-    videoServer.SetAttribute("PacketNum", UintegerValue(_pktPerFrame));
+    ConfigureRecovery(videoServer, videoClient, _recovery, _fec, _fecBlock, _fecParity);
 
-    ApplicationContainer serverApp = videoServer.Install(nodes.Get(0));
+    ApplicationContainer serverApp = videoServer.Install(serverNode.Get(0));
     serverApp.Start(Seconds(0.0));
     serverApp.Stop(Seconds(100.0));
 
-    pointToPoint.EnablePcap("videoStream", devices.Get(1), false);
-    Simulator::Run();
-    Simulator::Destroy();
+    ApplicationContainer clientApp;
+    for (uint32_t i = 0; i < _receivers; i++)
+    {
+      NetDeviceContainer devices = pointToPoint.Install(serverNode.Get(0), clientNodes.Get(i));
+      Ipv4InterfaceContainer interfaces = address.Assign(devices);
+      address.NewNetwork();
+      SetLoss(devices.Get(1), _loss);
+      if (i == 0 && clientNodes.Get(i)->GetSystemId() == g_rank)
+      {
+        pointToPoint.EnablePcap("videoStream", devices.Get(1), false);
+      }
+
+      // 각 클라이언트는 자기 링크 쪽 서버 주소로 접속한다
+      videoClient.SetAttribute("RemoteAddress", AddressValue(interfaces.GetAddress(0)));
+      clientApp.Add(videoClient.Install(NodeContainer(clientNodes.Get(i)), _clientsPerNode));
+    }
+    stats.AddClients(clientApp);
+    clientApp.Start(Seconds(1.0));
+    clientApp.Stop(Seconds(_clientStop));
+
+    ConnectCounters("/NodeList/1/DeviceList/*/$ns3::PointToPointNetDevice/MacRx", "/NodeList/0/DeviceList/*/$ns3::PointToPointNetDevice/MacTx");
+    RunAndReport(stats, _clientWindow, _stats, _latency);
   }
   else if (_case == 2)
   {
-    // Create Nodes : Make 1 STA and 1 AP
+    // Create Nodes : Make _receivers STAs contending for 1 AP
     NodeContainer wifiStaNode;
-    wifiStaNode.Create(1);
+    wifiStaNode.Create(_receivers);
     NodeContainer wifiApNode;
     wifiApNode.Create(1);
 
@@ -121,7 +589,7 @@ int main(int argc, char *argv[])
 
     Ipv4AddressHelper address;
 
-    address.SetBase("192.168.1.0", "255.255.255.0");
+    address.SetBase("192.168.0.0", "255.255.0.0");
     Ipv4InterfaceContainer apInterface;
     apInterface = address.Assign(apDevice);
     Ipv4InterfaceContainer wifiInterface;
@@ -132,8 +600,13 @@ int main(int argc, char *argv[])
     MobilityHelper mobility;
     Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
 
-    positionAlloc->Add(Vector(0.0, 0.0, 0.0)); // Add Vector x=0, y=0, z=0
-    positionAlloc->Add(Vector(1.0, 0.0, 0.0)); // Add Vector x=1, y=0, z=0
+    positionAlloc->Add(Vector(0.0, 0.0, 0.0)); // AP at x=0, y=0, z=0
+    for (uint32_t i = 0; i < _receivers; i++)
+    {
+      // STA들은 AP에서 1m 떨어진 원 위에 고르게 놓는다
+      double angle = 2 * M_PI * i / _receivers;
+      positionAlloc->Add(Vector(std::cos(angle), std::sin(angle), 0.0));
+    }
     mobility.SetPositionAllocator(positionAlloc);
 
     mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
@@ -142,26 +615,169 @@ int main(int argc, char *argv[])
 
     // Create Transport layer (UDP)
     VideoStreamServerHelper videoServer(5000);
-    videoServer.SetAttribute("PacketNum", UintegerValue(_pktPerFrame));
+    ConfigureServer(videoServer, _pktPerFrame, _pacing, _abr, _ccType, _trace, _priority, _dropBacklog);
+
+    VideoStreamClientHelper videoClient(apInterface.GetAddress(0), 5000);
+    videoClient.SetAttribute("PacketNum", UintegerValue(_pktPerFrame));
+    ConfigureRecovery(videoServer, videoClient, _recovery, _fec, _fecBlock, _fecParity);
 
     ApplicationContainer serverApp = videoServer.Install(wifiApNode.Get(0));
     serverApp.Start(Seconds(0.0));
     serverApp.Stop(Seconds(100.0));
 
-    VideoStreamClientHelper videoClient(apInterface.GetAddress(0), 5000);
-    videoClient.SetAttribute("PacketNum", UintegerValue(_pktPerFrame));
-    ApplicationContainer clientApp = videoClient.Install(wifiStaNode.Get(0));
+    ApplicationContainer clientApp = videoClient.Install(wifiStaNode, _clientsPerNode);
+    stats.AddClients(clientApp);
     clientApp.Start(Seconds(1.0));
-    clientApp.Stop(Seconds(100.0));
+    clientApp.Stop(Seconds(_clientStop));
 
     Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 
     // Simulator::Stop(Seconds(10.0));
 
     phy.EnablePcap("wifi-videoStream", apDevice.Get(0));
-    AnimationInterface anim("wifi-1-1.xml");
-    Simulator::Run();
-    Simulator::Destroy();
+    AnimationInterface anim("wifi-1-" + std::to_string(_receivers) + ".xml");
+    std::ostringstream apTxPath;
+    apTxPath << "/NodeList/" << wifiApNode.Get(0)->GetId() << "/DeviceList/*/$ns3::WifiNetDevice/Mac/MacTx";
+    ConnectCounters("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/Mac/MacRx", apTxPath.str());
+    RunAndReport(stats, _clientWindow, _stats, _latency);
+  }
+  else if (_case == 3)
+  {
+    // Node 0 is the server, nodes 1.._receivers are the clients, all on one CSMA segment
+    NodeContainer nodes;
+    nodes.Create(_receivers + 1);
+    NodeContainer clientNodes;
+    for (uint32_t i = 1; i <= _receivers; i++)
+    {
+      clientNodes.Add(nodes.Get(i));
+    }
+
+    CsmaHelper csma;
+    csma.SetChannelAttribute("DataRate", StringValue(_linkRate.empty() ? "1Gbps" : _linkRate));
+    csma.SetChannelAttribute("Delay", StringValue(_linkDelay.empty() ? "50us" : _linkDelay));
+    NetDeviceContainer devices = csma.Install(nodes);
+
+    InternetStackHelper stack;
+    stack.Install(nodes);
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.2.0.0", "255.255.0.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+    for (uint32_t i = 1; i <= _receivers; i++)
+    {
+      SetLoss(devices.Get(i), _loss);
+    }
+
+    VideoStreamServerHelper videoServer(5000);
+    ConfigureServer(videoServer, _pktPerFrame, _pacing, _abr, _ccType, _trace, _priority, _dropBacklog);
+
+    VideoStreamClientHelper videoClient(interfaces.GetAddress(0), 5000);
+    videoClient.SetAttribute("PacketNum", UintegerValue(_pktPerFrame));
+    ConfigureRecovery(videoServer, videoClient, _recovery, _fec, _fecBlock, _fecParity);
+
+    if (_multicast)
+    {
+      NS_ABORT_MSG_IF(_clientsPerNode > 1, "Clients of one node cannot share the multicast port");
+      Ipv4Address group("225.1.2.4");
+      Ipv4StaticRoutingHelper multicast;
+      multicast.SetDefaultMulticastRoute(nodes.Get(0), devices.Get(0));
+      videoServer.SetAttribute("MulticastGroup", Ipv4AddressValue(group));
+      videoClient.SetAttribute("MulticastGroup", Ipv4AddressValue(group));
+    }
+
+    ApplicationContainer serverApp = videoServer.Install(nodes.Get(0));
+    serverApp.Start(Seconds(0.0));
+    serverApp.Stop(Seconds(100.0));
+
+    ApplicationContainer clientApp = videoClient.Install(clientNodes, _clientsPerNode);
+    stats.AddClients(clientApp);
+    clientApp.Start(Seconds(1.0));
+    clientApp.Stop(Seconds(_clientStop));
+
+    ConnectCounters("/NodeList/1/DeviceList/*/$ns3::CsmaNetDevice/MacRx", "/NodeList/0/DeviceList/*/$ns3::CsmaNetDevice/MacTx");
+    RunAndReport(stats, _clientWindow, _stats, _latency);
+  }
+  else if (_case == 4)
+  {
+    // Tree: node 0 is the server, nodes 1.._clusters the routers, then the client nodes of each cluster
+    NS_ABORT_MSG_IF(_clusters == 0 || _clusters > _receivers, "Case 4 needs between 1 and --receivers clusters");
+    NodeContainer serverNode;
+    serverNode.Create(1, 0);
+    NodeContainer routers;
+    for (uint32_t c = 0; c < _clusters; c++)
+    {
+      routers.Create(1, GetRank(c, _clusters));
+    }
+    NodeContainer clientNodes;
+    for (uint32_t i = 0; i < _receivers; i++)
+    {
+      // 연속된 클라이언트 노드를 한 클러스터로 묶어 라우터와 같은 랭크에 둔다
+      clientNodes.Create(1, routers.Get(i * _clusters / _receivers)->GetSystemId());
+    }
+
+    InternetStackHelper stack;
+    stack.Install(serverNode);
+    stack.Install(routers);
+    stack.Install(clientNodes);
+
+    PointToPointHelper backbone;
+    backbone.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+    backbone.SetChannelAttribute("Delay", StringValue("5ms"));
+    PointToPointHelper access;
+    access.SetDeviceAttribute("DataRate", StringValue(_linkRate.empty() ? "100Mbps" : _linkRate));
+    access.SetChannelAttribute("Delay", StringValue(_linkDelay.empty() ? "2ms" : _linkDelay));
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.3.0.0", "255.255.255.252");
+    std::vector<Ipv4Address> serverAddresses;
+    for (uint32_t c = 0; c < _clusters; c++)
+    {
+      Ipv4InterfaceContainer interfaces = address.Assign(backbone.Install(serverNode.Get(0), routers.Get(c)));
+      address.NewNetwork();
+      serverAddresses.push_back(interfaces.GetAddress(0));
+    }
+    for (uint32_t i = 0; i < _receivers; i++)
+    {
+      NetDeviceContainer devices = access.Install(routers.Get(i * _clusters / _receivers), clientNodes.Get(i));
+      address.Assign(devices);
+      address.NewNetwork();
+      SetLoss(devices.Get(1), _loss);
+    }
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    VideoStreamServerHelper videoServer(5000);
+    ConfigureServer(videoServer, _pktPerFrame, _pacing, _abr, _ccType, _trace, _priority, _dropBacklog);
+
+    VideoStreamClientHelper videoClient(Ipv4Address::GetAny(), 5000);
+    videoClient.SetAttribute("PacketNum", UintegerValue(_pktPerFrame));
+    ConfigureRecovery(videoServer, videoClient, _recovery, _fec, _fecBlock, _fecParity);
+
+    ApplicationContainer serverApp = videoServer.Install(serverNode.Get(0));
+    serverApp.Start(Seconds(0.0));
+    serverApp.Stop(Seconds(100.0));
+
+    ApplicationContainer clientApp;
+    for (uint32_t i = 0; i < _receivers; i++)
+    {
+      // 각 클라이언트는 자기 클러스터로 이어진 서버 주소로 접속한다
+      videoClient.SetAttribute("RemoteAddress", AddressValue(serverAddresses[i * _clusters / _receivers]));
+      clientApp.Add(videoClient.Install(NodeContainer(clientNodes.Get(i)), _clientsPerNode));
+    }
+    stats.AddClients(clientApp);
+    clientApp.Start(Seconds(1.0));
+    clientApp.Stop(Seconds(_clientStop));
+
+    std::ostringstream clientRxPath;
+    clientRxPath << "/NodeList/" << clientNodes.Get(0)->GetId() << "/DeviceList/*/$ns3::PointToPointNetDevice/MacRx";
+    ConnectCounters(clientRxPath.str(), "/NodeList/0/DeviceList/*/$ns3::PointToPointNetDevice/MacTx");
+    RunAndReport(stats, _clientWindow, _stats, _latency);
+  }
+#ifdef NS3_MPI
+  if (_mpi)
+  {
+    MpiInterface::Disable();
   }
+#endif
   return 0;
 }
\ No newline at end of file
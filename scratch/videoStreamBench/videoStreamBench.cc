@@ -0,0 +1,359 @@
+/*****************************************************
+ *
+ * File:  videoStreamBench.cc
+ *
+ * Explanation:  This script measures how the video stream server and
+ *               clients scale with the number of clients, the packets
+ *               per frame, the link rate, the loss rate and the topology.
+ *
+ *****************************************************/
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/map-scheduler.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * @brief Sweep benchmark of the video stream applications.
+ *
+ * Every parameter takes a comma separated list and every combination is
+ * run once. Topologies:
+ * - Star: one p2p link between the server and each client
+ * - Csma: the server and all clients on one CSMA segment
+ *
+ * One CSV line is written per run with the simulator wall-clock time,
+ * executed events, events per second of wall-clock time, peak RSS and peak
+ * RSS per client, packets sent by the server and the QoE metrics of
+ * VideoStreamStatsCollector averaged over the clients.
+ *
+ * --scheduling compares the server's per-client send events (PerClient)
+ * with one send tick per interval for all clients (Batched).
+ *
+ * With --fork (default) each run is executed in a child process, so the
+ * peak RSS is that of the run alone and not the maximum of all earlier runs.
+ */
+
+NS_LOG_COMPONENT_DEFINE("VideoStreamBench");
+
+static uint64_t g_events = 0;
+static uint64_t g_txPackets = 0;
+
+/**
+ * @brief Map scheduler that counts the executed events.
+ */
+class CountingMapScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId(void)
+  {
+    static TypeId tid = TypeId("ns3::CountingMapScheduler")
+                            .SetParent<MapScheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<CountingMapScheduler>();
+    return tid;
+  }
+
+  virtual Scheduler::Event RemoveNext(void)
+  {
+    g_events++;
+    return MapScheduler::RemoveNext();
+  }
+};
+
+NS_OBJECT_ENSURE_REGISTERED(CountingMapScheduler);
+
+/**
+ * @brief One point of the sweep.
+ */
+struct BenchPoint
+{
+  std::string topology;
+  std::string mode;
+  std::string scheduling;
+  uint32_t clients;
+  uint32_t pktPerFrame;
+  std::string linkRate;
+  double loss;
+};
+
+static void
+CountTx(Ptr<const Packet> packet)
+{
+  g_txPackets++;
+}
+
+/**
+ * @brief Drop a fraction of the packets received by a device.
+ */
+static void
+SetLoss(Ptr<NetDevice> device, double loss)
+{
+  if (loss > 0)
+  {
+    Ptr<RateErrorModel> errorModel = CreateObject<RateErrorModel>();
+    errorModel->SetAttribute("ErrorRate", DoubleValue(loss));
+    errorModel->SetAttribute("ErrorUnit", StringValue("ERROR_UNIT_PACKET"));
+    device->SetAttribute("ReceiveErrorModel", PointerValue(errorModel));
+  }
+}
+
+/**
+ * @return the peak resident set size of this process in kB
+ */
+static long
+GetPeakRssKb(void)
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static std::string
+GetCsvHeader(void)
+{
+  return "topology,mode,scheduling,clients,pktPerFrame,linkRate,loss,simSec,wallMs,events,eventsPerSec,peakRssKb,rssPerClientKb,txPackets,"
+         "ttff,startupDelay,stalls,stallTime,rebufferRatio,goodput,retransOverhead,retransRequests,framesComplete,framesPartial,framesMissing,framesUndecodable,adaptedRatio";
+}
+
+/**
+ * @brief Simulate one point of the sweep.
+ *
+ * @return the CSV line of the run
+ */
+static std::string
+RunOnce(const BenchPoint &point, double duration)
+{
+  g_events = 0;
+  g_txPackets = 0;
+
+  ObjectFactory scheduler;
+  scheduler.SetTypeId("ns3::CountingMapScheduler");
+  Simulator::SetScheduler(scheduler);
+
+  NodeContainer serverNode;
+  serverNode.Create(1);
+  NodeContainer clientNodes;
+  clientNodes.Create(point.clients);
+
+  InternetStackHelper stack;
+  stack.Install(serverNode);
+  stack.Install(clientNodes);
+
+  std::vector<Ipv4Address> serverAddresses;
+  std::string txPath;
+  if (point.topology == "Star")
+  {
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(point.linkRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i < point.clients; i++)
+    {
+      NetDeviceContainer devices = pointToPoint.Install(serverNode.Get(0), clientNodes.Get(i));
+      Ipv4InterfaceContainer interfaces = address.Assign(devices);
+      address.NewNetwork();
+      SetLoss(devices.Get(1), point.loss);
+      serverAddresses.push_back(interfaces.GetAddress(0));
+    }
+    txPath = "/NodeList/0/DeviceList/*/$ns3::PointToPointNetDevice/MacTx";
+  }
+  else if (point.topology == "Csma")
+  {
+    CsmaHelper csma;
+    csma.SetChannelAttribute("DataRate", StringValue(point.linkRate));
+    csma.SetChannelAttribute("Delay", StringValue("50us"));
+    NetDeviceContainer devices = csma.Install(NodeContainer(serverNode, clientNodes));
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.0.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+    for (uint32_t i = 1; i <= point.clients; i++)
+    {
+      SetLoss(devices.Get(i), point.loss);
+      serverAddresses.push_back(interfaces.GetAddress(0));
+    }
+    txPath = "/NodeList/0/DeviceList/*/$ns3::CsmaNetDevice/MacTx";
+  }
+  else
+  {
+    NS_ABORT_MSG("Unknown topology " << point.topology);
+  }
+
+  VideoStreamServerHelper videoServer(5000);
+  videoServer.SetAttribute("PacketNum", UintegerValue(point.pktPerFrame));
+  videoServer.SetAttribute("PayloadMode", StringValue(point.mode));
+  videoServer.SetAttribute("SendScheduling", StringValue(point.scheduling));
+  ApplicationContainer serverApp = videoServer.Install(serverNode.Get(0));
+  serverApp.Start(Seconds(0.0));
+  serverApp.Stop(Seconds(duration));
+
+  VideoStreamStatsCollector stats;
+  for (uint32_t i = 0; i < point.clients; i++)
+  {
+    VideoStreamClientHelper videoClient(serverAddresses[i], 5000);
+    videoClient.SetAttribute("PacketNum", UintegerValue(point.pktPerFrame));
+    ApplicationContainer clientApp = videoClient.Install(clientNodes.Get(i));
+    clientApp.Start(Seconds(1.0));
+    clientApp.Stop(Seconds(duration));
+    stats.AddClients(clientApp);
+  }
+
+  Config::ConnectWithoutContext(txPath, MakeCallback(&CountTx));
+
+  Simulator::Stop(Seconds(duration));
+  SystemWallClockMs clock;
+  clock.Start();
+  Simulator::Run();
+  int64_t wallMs = clock.End();
+  VideoStreamStatsCollector::Metrics qoe = stats.GetMean();
+  Simulator::Destroy();
+
+  double eventsPerSec = wallMs > 0 ? g_events * 1000.0 / wallMs : 0.0;
+  long peakRssKb = GetPeakRssKb();
+  std::ostringstream line;
+  line << point.topology << "," << point.mode << "," << point.scheduling << "," << point.clients << "," << point.pktPerFrame << ","
+       << point.linkRate << "," << point.loss << "," << duration << ","
+       << wallMs << "," << g_events << "," << eventsPerSec << "," << peakRssKb << ","
+       << static_cast<double>(peakRssKb) / point.clients << "," << g_txPackets << ","
+       << qoe.m_ttff << "," << qoe.m_startupDelay << "," << qoe.m_stalls << "," << qoe.m_stallTime << "," << qoe.m_rebufferRatio << ","
+       << qoe.m_goodput << "," << qoe.m_retransOverhead << "," << qoe.m_retransRequests << ","
+       << qoe.m_framesComplete << "," << qoe.m_framesPartial << "," << qoe.m_framesMissing << "," << qoe.m_framesUndecodable << "," << qoe.m_adaptedRatio;
+  return line.str();
+}
+
+/**
+ * @brief Run one point in a child process and read back its CSV line.
+ */
+static std::string
+RunForked(const BenchPoint &point, double duration)
+{
+  int fds[2];
+  NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe failed");
+  pid_t pid = fork();
+  NS_ABORT_MSG_IF(pid < 0, "fork failed");
+  if (pid == 0)
+  {
+    close(fds[0]);
+    std::string line = RunOnce(point, duration);
+    ssize_t written = write(fds[1], line.c_str(), line.size());
+    close(fds[1]);
+    _exit(written == static_cast<ssize_t>(line.size()) ? 0 : 1);
+  }
+
+  close(fds[1]);
+  std::string line;
+  char buf[512];
+  ssize_t n;
+  while ((n = read(fds[0], buf, sizeof(buf))) > 0)
+  {
+    line.append(buf, n);
+  }
+  close(fds[0]);
+  int status;
+  waitpid(pid, &status, 0);
+  NS_ABORT_MSG_UNLESS(WIFEXITED(status) && WEXITSTATUS(status) == 0, "Run of " << point.clients << " clients failed");
+  return line;
+}
+
+/**
+ * @brief Split a comma separated list.
+ */
+static std::vector<std::string>
+Split(std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ','))
+  {
+    if (!item.empty())
+    {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+int main(int argc, char *argv[])
+{
+  CommandLine cmd;
+  std::string _clients = "1,10,100,1000";
+  std::string _pktPerFrame = "10";
+  std::string _linkRate = "1Gbps";
+  std::string _loss = "0";
+  std::string _topology = "Star";
+  std::string _modes = "Stamped";
+  std::string _scheduling = "Batched";
+  double _duration = 5.0;
+  bool _fork = true;
+  std::string _output = "";
+  cmd.AddValue("clients", "comma separated # of clients", _clients);
+  cmd.AddValue("pktPerFrame", "comma separated # of packets per frame", _pktPerFrame);
+  cmd.AddValue("linkRate", "comma separated data rates of the links", _linkRate);
+  cmd.AddValue("loss", "comma separated packet loss rates on the client links", _loss);
+  cmd.AddValue("topology", "comma separated topologies (Star, Csma)", _topology);
+  cmd.AddValue("modes", "comma separated payload modes (Copy, Stamped, Virtual)", _modes);
+  cmd.AddValue("scheduling", "comma separated send schedulings of the server (PerClient, Batched)", _scheduling);
+  cmd.AddValue("duration", "simulated seconds", _duration);
+  cmd.AddValue("fork", "run every point in its own process to measure its peak RSS", _fork);
+  cmd.AddValue("output", "CSV file, standard output if empty", _output);
+  cmd.Parse(argc, argv);
+
+  Time::SetResolution(Time::NS);
+
+  std::ofstream file;
+  if (!_output.empty())
+  {
+    file.open(_output.c_str());
+    NS_ABORT_MSG_UNLESS(file.is_open(), "Cannot open " << _output);
+  }
+  std::ostream &os = _output.empty() ? std::cout : file;
+
+  os << GetCsvHeader() << std::endl;
+  for (const std::string &topology : Split(_topology))
+  {
+    for (const std::string &mode : Split(_modes))
+    {
+      for (const std::string &scheduling : Split(_scheduling))
+      {
+        for (const std::string &clients : Split(_clients))
+        {
+          for (const std::string &pktPerFrame : Split(_pktPerFrame))
+          {
+            for (const std::string &linkRate : Split(_linkRate))
+            {
+              for (const std::string &loss : Split(_loss))
+              {
+                BenchPoint point;
+                point.topology = topology;
+                point.mode = mode;
+                point.scheduling = scheduling;
+                point.clients = std::stoul(clients);
+                point.pktPerFrame = std::stoul(pktPerFrame);
+                point.linkRate = linkRate;
+                point.loss = std::stod(loss);
+                os << (_fork ? RunForked(point, _duration) : RunOnce(point, _duration)) << std::endl;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return 0;
+}
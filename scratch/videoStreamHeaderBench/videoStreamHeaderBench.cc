@@ -0,0 +1,218 @@
+/*****************************************************
+ *
+ * File:  videoStreamHeaderBench.cc
+ *
+ * Explanation:  This script measures the cost of adding and removing the
+ *               per-packet header of the video stream, against the
+ *               SeqTsHeader and 6-byte frame header it replaced.
+ *
+ *****************************************************/
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/seq-ts-header.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * @brief Microbenchmark of the video stream packet header.
+ *
+ * Batches of packets get the header added (serialize) and removed again
+ * (deserialize), the way the server and the client do for every packet.
+ * One CSV line is written per header layout with its size and the
+ * nanoseconds per packet of each direction:
+ * - Legacy: SeqTsHeader followed by the former 6-byte frame header
+ * - Compact: VideoStreamFrameHeader alone, the stride travels once per
+ *   client in a VideoStreamInfoHeader and is not counted
+ *
+ * The checksum of the deserialized fields keeps the work from being
+ * optimized away and must be equal for both layouts.
+ */
+
+NS_LOG_COMPONENT_DEFINE("VideoStreamHeaderBench");
+
+/**
+ * @brief The frame header as it was before it carried the frame number,
+ * packet index and timestamp, sent after a SeqTsHeader.
+ *
+ * Layout: packets of the frame (2 bytes) | sequence numbers per frame (2 bytes) |
+ *         frame type (1 byte) | reference distance (1 byte)
+ */
+class LegacyFrameHeader : public Header
+{
+public:
+  static TypeId GetTypeId(void)
+  {
+    static TypeId tid = TypeId("ns3::LegacyFrameHeader")
+                            .SetParent<Header>()
+                            .AddConstructor<LegacyFrameHeader>();
+    return tid;
+  }
+  LegacyFrameHeader()
+      : m_framePackets(0), m_stride(0), m_frameType(0), m_refDistance(0)
+  {
+  }
+  virtual TypeId GetInstanceTypeId(void) const
+  {
+    return GetTypeId();
+  }
+  virtual void Print(std::ostream &os) const
+  {
+    os << "(packets=" << m_framePackets << " stride=" << m_stride << ")";
+  }
+  virtual uint32_t GetSerializedSize(void) const
+  {
+    return 6;
+  }
+  virtual void Serialize(Buffer::Iterator start) const
+  {
+    start.WriteHtonU16(m_framePackets);
+    start.WriteHtonU16(m_stride);
+    start.WriteU8(m_frameType);
+    start.WriteU8(m_refDistance);
+  }
+  virtual uint32_t Deserialize(Buffer::Iterator start)
+  {
+    m_framePackets = start.ReadNtohU16();
+    m_stride = start.ReadNtohU16();
+    m_frameType = start.ReadU8();
+    m_refDistance = start.ReadU8();
+    return 6;
+  }
+
+  uint16_t m_framePackets;
+  uint16_t m_stride;
+  uint8_t m_frameType;
+  uint8_t m_refDistance;
+};
+
+/**
+ * @brief Time of both directions for one header layout.
+ */
+struct Result
+{
+  double serializeNs = 0;   //!< Total nanoseconds spent adding headers
+  double deserializeNs = 0; //!< Total nanoseconds spent removing headers
+  uint64_t checksum = 0;    //!< Sum of the frame numbers and packet indexes read back
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double
+ElapsedNs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Add and remove the SeqTsHeader and the legacy frame header.
+ *
+ * The frame number and index are derived from the sequence number with a
+ * division, as the client used to.
+ */
+static void
+RunLegacy(std::vector<Ptr<Packet>> &batch, uint32_t first, uint32_t stride, Result &result)
+{
+  Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < batch.size(); i++)
+  {
+    uint32_t seqNum = first + i;
+    LegacyFrameHeader frameHeader;
+    frameHeader.m_framePackets = stride;
+    frameHeader.m_stride = stride;
+    frameHeader.m_refDistance = 1;
+    batch[i]->AddHeader(frameHeader);
+    SeqTsHeader seqTs;
+    seqTs.SetSeq(seqNum);
+    batch[i]->AddHeader(seqTs);
+  }
+  result.serializeNs += ElapsedNs(start);
+
+  start = Clock::now();
+  for (uint32_t i = 0; i < batch.size(); i++)
+  {
+    SeqTsHeader seqTs;
+    batch[i]->RemoveHeader(seqTs);
+    LegacyFrameHeader frameHeader;
+    batch[i]->RemoveHeader(frameHeader);
+    uint32_t seqNum = seqTs.GetSeq();
+    result.checksum += seqNum / frameHeader.m_stride + seqNum % frameHeader.m_stride;
+  }
+  result.deserializeNs += ElapsedNs(start);
+}
+
+/**
+ * @brief Add and remove the compact VideoStreamFrameHeader.
+ */
+static void
+RunCompact(std::vector<Ptr<Packet>> &batch, uint32_t first, uint32_t stride, Result &result)
+{
+  Clock::time_point start = Clock::now();
+  Time now = Simulator::Now();
+  for (uint32_t i = 0; i < batch.size(); i++)
+  {
+    uint32_t seqNum = first + i;
+    VideoStreamFrameHeader header;
+    header.SetFrameNum(seqNum / stride);
+    header.SetPacketIndex(seqNum % stride);
+    header.SetFramePackets(stride);
+    header.SetRefDistance(1);
+    header.SetTimestamp(now);
+    batch[i]->AddHeader(header);
+  }
+  result.serializeNs += ElapsedNs(start);
+
+  start = Clock::now();
+  for (uint32_t i = 0; i < batch.size(); i++)
+  {
+    VideoStreamFrameHeader header;
+    batch[i]->RemoveHeader(header);
+    result.checksum += header.GetFrameNum() + header.GetPacketIndex();
+  }
+  result.deserializeNs += ElapsedNs(start);
+}
+
+int main(int argc, char *argv[])
+{
+  CommandLine cmd;
+  uint32_t _packets = 1000000;
+  uint32_t _batch = 1024;
+  uint32_t _payload = 1400;
+  uint32_t _pktPerFrame = 100;
+  cmd.AddValue("packets", "packets per header layout", _packets);
+  cmd.AddValue("batch", "packets that get their header added before it is removed again", _batch);
+  cmd.AddValue("payload", "payload bytes of each packet", _payload);
+  cmd.AddValue("pktPerFrame", "# of packets per frame", _pktPerFrame);
+  cmd.Parse(argc, argv);
+  NS_ABORT_MSG_IF(_batch == 0 || _pktPerFrame == 0 || _pktPerFrame > 0xffff, "Invalid --batch or --pktPerFrame");
+  // 24비트 프레임 번호를 넘지 않게 한다
+  NS_ABORT_MSG_IF(_packets / _pktPerFrame > 0xffffff, "Too many frames for --packets and --pktPerFrame");
+
+  std::vector<Ptr<Packet>> batch(_batch);
+  Result legacy;
+  Result compact;
+  for (uint32_t first = 0; first < _packets; first += _batch)
+  {
+    uint32_t n = std::min(_batch, _packets - first);
+    batch.resize(n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+      batch[i] = Create<Packet>(_payload);
+    }
+    RunLegacy(batch, first, _pktPerFrame, legacy);
+    RunCompact(batch, first, _pktPerFrame, compact);
+  }
+  NS_ABORT_MSG_UNLESS(legacy.checksum == compact.checksum, "The layouts read back different packets");
+
+  std::cout << "header,bytes,packets,serializeNsPerPacket,deserializeNsPerPacket" << std::endl;
+  std::cout << "Legacy," << SeqTsHeader().GetSerializedSize() + LegacyFrameHeader().GetSerializedSize() << "," << _packets << ","
+            << legacy.serializeNs / _packets << "," << legacy.deserializeNs / _packets << std::endl;
+  std::cout << "Compact," << VideoStreamFrameHeader().GetSerializedSize() << "," << _packets << ","
+            << compact.serializeNs / _packets << "," << compact.deserializeNs / _packets << std::endl;
+  return 0;
+}
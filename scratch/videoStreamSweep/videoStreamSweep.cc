@@ -0,0 +1,444 @@
+/*****************************************************
+ *
+ * File:  videoStreamSweep.cc
+ *
+ * Explanation:  This script runs many videoStream simulations in parallel
+ *               and merges their QoE statistics into one table with
+ *               confidence intervals.
+ *
+ *****************************************************/
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * @brief Parallel parameter sweep of the videoStream scenario.
+ *
+ * Every combination of --cases, --pktPerFrame, --linkRate, --linkDelay and
+ * --loss is a point, and every point runs --runs times with RngRun 1..runs
+ * and RngSeed --seed. Up to --jobs runs execute at once, each as its own
+ * videoStream process writing its per-client statistics with --stats.
+ *
+ * When a run ends, the mean over its clients is appended to --output, so
+ * the file always holds finished runs only. Started again with the same
+ * --output, the sweep skips the runs already in it. Finally the runs of
+ * every point are merged into --summary: the mean of each metric and the
+ * half width of its 95% confidence interval (Student's t).
+ */
+
+NS_LOG_COMPONENT_DEFINE("VideoStreamSweep");
+
+/**
+ * @brief One run of the sweep.
+ */
+struct SweepRun
+{
+  std::string caseNum;
+  std::string pktPerFrame;
+  std::string linkRate;
+  std::string linkDelay;
+  std::string loss;
+  uint32_t seed;
+  uint32_t run;
+
+  /**
+   * @return the point of the run as CSV columns
+   */
+  std::string GetPoint(void) const
+  {
+    return caseNum + "," + pktPerFrame + "," + linkRate + "," + linkDelay + "," + loss;
+  }
+
+  /**
+   * @return the point, seed and run number as CSV columns
+   */
+  std::string GetKey(void) const
+  {
+    std::ostringstream key;
+    key << GetPoint() << "," << seed << "," << run;
+    return key.str();
+  }
+};
+
+static const std::string POINT_COLUMNS = "case,pktPerFrame,linkRate,linkDelay,loss";
+static const uint32_t KEY_COLUMNS = 7; //!< Point columns, seed and run
+
+/**
+ * @brief Split a comma separated list.
+ */
+static std::vector<std::string>
+Split(std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ','))
+  {
+    items.push_back(item);
+  }
+  return items;
+}
+
+/**
+ * @brief Get the two-sided 95% quantile of Student's t distribution.
+ *
+ * @param df the degrees of freedom
+ */
+static double
+GetStudentT(uint32_t df)
+{
+  static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (df == 0)
+  {
+    return 0;
+  }
+  return df <= 30 ? table[df - 1] : 1.96;
+}
+
+/**
+ * @brief Average the client rows of a --stats file.
+ *
+ * The TTFF and the startup delay are averaged over the clients that
+ * completed or played a frame, like VideoStreamStatsCollector::GetMean.
+ *
+ * @param filename the statistics file of one run
+ * @param header set to the metric columns of the file
+ * @param mean set to the mean of every metric column
+ * @return false if the file is missing or has no client
+ */
+static bool
+ReadStats(std::string filename, std::string &header, std::vector<double> &mean)
+{
+  std::ifstream file(filename.c_str());
+  std::string line;
+  if (!std::getline(file, line))
+  {
+    return false;
+  }
+  // 첫 열은 클라이언트 이름이므로 지표 열만 남긴다
+  header = line.substr(line.find(',') + 1);
+  uint32_t columns = Split(header).size();
+  std::vector<double> sum(columns, 0.0);
+  std::vector<uint32_t> count(columns, 0);
+  while (std::getline(file, line))
+  {
+    std::vector<std::string> items = Split(line);
+    if (items.size() != columns + 1)
+    {
+      continue;
+    }
+    for (uint32_t i = 0; i < columns; i++)
+    {
+      double value = std::stod(items[i + 1]);
+      if (value < 0)
+      {
+        continue; // 프레임을 완성하거나 재생하지 못한 클라이언트의 TTFF, startupDelay
+      }
+      sum[i] += value;
+      count[i]++;
+    }
+  }
+  if (count.empty() || count.back() == 0)
+  {
+    return false;
+  }
+  mean.resize(columns);
+  for (uint32_t i = 0; i < columns; i++)
+  {
+    mean[i] = count[i] > 0 ? sum[i] / count[i] : -1;
+  }
+  return true;
+}
+
+/**
+ * @brief Start one videoStream process.
+ *
+ * @return the process id
+ */
+static pid_t
+StartRun(const SweepRun &run, std::string program, std::string extra, std::string statsFile)
+{
+  std::vector<std::string> args;
+  args.push_back(program);
+  args.push_back("--case=" + run.caseNum);
+  args.push_back("--pktPerFrame=" + run.pktPerFrame);
+  if (!run.linkRate.empty())
+  {
+    args.push_back("--linkRate=" + run.linkRate);
+  }
+  if (!run.linkDelay.empty())
+  {
+    args.push_back("--linkDelay=" + run.linkDelay);
+  }
+  args.push_back("--loss=" + run.loss);
+  args.push_back("--RngSeed=" + std::to_string(run.seed));
+  args.push_back("--RngRun=" + std::to_string(run.run));
+  args.push_back("--stats=" + statsFile);
+  std::istringstream extraArgs(extra);
+  std::string arg;
+  while (extraArgs >> arg)
+  {
+    args.push_back(arg);
+  }
+
+  pid_t pid = fork();
+  NS_ABORT_MSG_IF(pid < 0, "fork failed");
+  if (pid == 0)
+  {
+    // 시뮬레이션의 재생 로그는 버린다
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    dup2(null, STDERR_FILENO);
+    std::vector<char *> argv;
+    for (uint32_t i = 0; i < args.size(); i++)
+    {
+      argv.push_back(const_cast<char *>(args[i].c_str()));
+    }
+    argv.push_back(0);
+    execv(program.c_str(), &argv[0]);
+    _exit(127);
+  }
+  return pid;
+}
+
+/**
+ * @brief Merge the runs of every point into mean and confidence interval columns.
+ */
+static void
+WriteSummary(std::string outputFile, std::string summaryFile)
+{
+  std::ifstream input(outputFile.c_str());
+  std::string header;
+  NS_ABORT_MSG_UNLESS(std::getline(input, header), "No runs in " << outputFile);
+  std::vector<std::string> columns = Split(header);
+  uint32_t metrics = columns.size() - KEY_COLUMNS;
+
+  // 점마다 지표별 값 목록 (점 순서는 처음 나온 순서)
+  std::vector<std::string> points;
+  std::map<std::string, std::vector<std::vector<double>>> values;
+  std::string line;
+  while (std::getline(input, line))
+  {
+    std::vector<std::string> items = Split(line);
+    if (items.size() != columns.size())
+    {
+      continue;
+    }
+    std::string point = items[0];
+    for (uint32_t i = 1; i < KEY_COLUMNS - 2; i++)
+    {
+      point += "," + items[i];
+    }
+    if (values.find(point) == values.end())
+    {
+      points.push_back(point);
+      values[point].resize(metrics);
+    }
+    for (uint32_t m = 0; m < metrics; m++)
+    {
+      double value = std::stod(items[KEY_COLUMNS + m]);
+      if (m == 0 && value < 0)
+      {
+        continue; // TTFF가 없는 실행
+      }
+      values[point][m].push_back(value);
+    }
+  }
+
+  std::ofstream os(summaryFile.c_str());
+  NS_ABORT_MSG_UNLESS(os.is_open(), "Cannot open " << summaryFile);
+  os << POINT_COLUMNS << ",runs";
+  for (uint32_t m = 0; m < metrics; m++)
+  {
+    os << "," << columns[KEY_COLUMNS + m] << "," << columns[KEY_COLUMNS + m] << "Ci95";
+  }
+  os << std::endl;
+  for (uint32_t p = 0; p < points.size(); p++)
+  {
+    const std::vector<std::vector<double>> &point = values[points[p]];
+    os << points[p] << "," << point.back().size();
+    for (uint32_t m = 0; m < metrics; m++)
+    {
+      const std::vector<double> &samples = point[m];
+      double n = samples.size();
+      double mean = 0;
+      for (uint32_t i = 0; i < samples.size(); i++)
+      {
+        mean += samples[i] / n;
+      }
+      double var = 0;
+      for (uint32_t i = 0; i < samples.size(); i++)
+      {
+        var += (samples[i] - mean) * (samples[i] - mean);
+      }
+      double ci = n > 1 ? GetStudentT(n - 1) * std::sqrt(var / (n - 1) / n) : 0;
+      os << "," << (n > 0 ? mean : -1) << "," << ci;
+    }
+    os << std::endl;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  CommandLine cmd;
+  std::string _program = "build/scratch/videoStream/videoStream";
+  std::string _cases = "1";
+  std::string _pktPerFrame = "100";
+  std::string _linkRate = "";
+  std::string _linkDelay = "";
+  std::string _loss = "0";
+  uint32_t _runs = 5;
+  uint32_t _seed = 1;
+  uint32_t _jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  std::string _extra = "";
+  std::string _output = "sweep-runs.csv";
+  std::string _summary = "sweep.csv";
+  cmd.AddValue("program", "the videoStream executable", _program);
+  cmd.AddValue("cases", "comma separated test cases", _cases);
+  cmd.AddValue("pktPerFrame", "comma separated # of packets per frame", _pktPerFrame);
+  cmd.AddValue("linkRate", "comma separated data rates of the client links, empty for the case default", _linkRate);
+  cmd.AddValue("linkDelay", "comma separated delays of the client links, empty for the case default", _linkDelay);
+  cmd.AddValue("loss", "comma separated packet loss rates on the client links", _loss);
+  cmd.AddValue("runs", "runs of every point, with RngRun 1..runs", _runs);
+  cmd.AddValue("seed", "RngSeed of every run", _seed);
+  cmd.AddValue("jobs", "runs executed at once, the number of cores by default", _jobs);
+  cmd.AddValue("extra", "space separated arguments added to every run", _extra);
+  cmd.AddValue("output", "CSV file of the finished runs, appended to and used to resume", _output);
+  cmd.AddValue("summary", "CSV file of the mean and 95% confidence interval of every point", _summary);
+  cmd.Parse(argc, argv);
+  NS_ABORT_MSG_IF(access(_program.c_str(), X_OK) != 0, "Cannot execute " << _program);
+  _jobs = std::max<uint32_t>(_jobs, 1);
+
+  std::vector<SweepRun> runs;
+  for (const std::string &caseNum : Split(_cases))
+  {
+    for (const std::string &pktPerFrame : Split(_pktPerFrame))
+    {
+      for (const std::string &linkRate : _linkRate.empty() ? std::vector<std::string>(1) : Split(_linkRate))
+      {
+        for (const std::string &linkDelay : _linkDelay.empty() ? std::vector<std::string>(1) : Split(_linkDelay))
+        {
+          for (const std::string &loss : Split(_loss))
+          {
+            for (uint32_t r = 1; r <= _runs; r++)
+            {
+              SweepRun run = {caseNum, pktPerFrame, linkRate, linkDelay, loss, _seed, r};
+              runs.push_back(run);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // 이전에 끝난 실행은 건너뛴다
+  std::set<std::string> finished;
+  std::string header;
+  {
+    std::ifstream previous(_output.c_str());
+    std::string line;
+    if (std::getline(previous, header))
+    {
+      while (std::getline(previous, line))
+      {
+        std::vector<std::string> items = Split(line);
+        if (items.size() == Split(header).size())
+        {
+          std::string key = items[0];
+          for (uint32_t i = 1; i < KEY_COLUMNS; i++)
+          {
+            key += "," + items[i];
+          }
+          finished.insert(key);
+        }
+      }
+    }
+  }
+  std::ofstream output(_output.c_str(), std::ios::app);
+  NS_ABORT_MSG_UNLESS(output.is_open(), "Cannot open " << _output);
+
+  std::map<pid_t, uint32_t> running; // process id -> index in runs
+  uint32_t next = 0;
+  uint32_t done = 0;
+  uint32_t failed = 0;
+  uint32_t skipped = 0;
+  while (next < runs.size() || !running.empty())
+  {
+    while (running.size() < _jobs && next < runs.size())
+    {
+      if (finished.count(runs[next].GetKey()) == 0)
+      {
+        std::string statsFile = _output + ".run" + std::to_string(next) + ".csv";
+        running[StartRun(runs[next], _program, _extra, statsFile)] = next;
+      }
+      else
+      {
+        skipped++;
+      }
+      next++;
+    }
+    if (running.empty())
+    {
+      break;
+    }
+
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0 || running.find(pid) == running.end())
+    {
+      continue;
+    }
+    uint32_t index = running[pid];
+    running.erase(pid);
+    const SweepRun &run = runs[index];
+    std::string statsFile = _output + ".run" + std::to_string(index) + ".csv";
+    std::string statsHeader;
+    std::vector<double> mean;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !ReadStats(statsFile, statsHeader, mean))
+    {
+      std::cerr << "run " << run.GetKey() << " failed" << std::endl;
+      failed++;
+      std::remove(statsFile.c_str());
+      continue;
+    }
+    std::remove(statsFile.c_str());
+
+    std::string runHeader = POINT_COLUMNS + ",seed,run," + statsHeader;
+    if (header.empty())
+    {
+      header = runHeader;
+      output << header << std::endl;
+    }
+    NS_ABORT_MSG_UNLESS(header == runHeader, _output << " was written by another version of videoStream");
+    output << run.GetKey();
+    for (uint32_t i = 0; i < mean.size(); i++)
+    {
+      output << "," << mean[i];
+    }
+    output << std::endl;
+    done++;
+    std::cout << "finished " << run.GetKey() << " (" << done << " new, " << running.size() << " running)" << std::endl;
+  }
+  output.close();
+
+  std::cout << done << " runs finished, " << skipped << " skipped, " << failed << " failed" << std::endl;
+  if (!header.empty())
+  {
+    WriteSummary(_output, _summary);
+  }
+  return failed > 0 ? 1 : 0;
+}
@@ -5,9 +5,19 @@
 #include "ns3/video-stream-client.h"
 #include "ns3/uinteger.h"
 #include "ns3/names.h"
+#include "ns3/simulator.h"
 
 namespace ns3{
 
+/**
+ * \returns true if the node is simulated by this rank of a distributed simulation
+ */
+static bool
+IsLocalNode (Ptr<Node> node)
+{
+  return node->GetSystemId () == Simulator::GetSystemId ();
+}
+
 VideoStreamServerHelper::VideoStreamServerHelper(uint16_t port)
 {
   m_factory.SetTypeId (VideoStreamServer::GetTypeId ());
@@ -23,6 +33,10 @@ VideoStreamServerHelper::SetAttribute(std::string name, const AttributeValue &va
 ApplicationContainer 
 VideoStreamServerHelper::Install (Ptr<Node> node) const
 {
+  if (!IsLocalNode (node))
+  {
+    return ApplicationContainer ();
+  }
   return ApplicationContainer (InstallPriv (node));
 }
 
@@ -30,7 +44,7 @@ ApplicationContainer
 VideoStreamServerHelper::Install (std::string nodeName) const
 {
   Ptr<Node> node = Names::Find<Node> (nodeName);
-  return ApplicationContainer (InstallPriv (node));
+  return Install (node);
 }
 
 ApplicationContainer 
@@ -39,7 +53,10 @@ VideoStreamServerHelper::Install (NodeContainer c) const
   ApplicationContainer apps;
   for (NodeContainer::Iterator i = c.Begin(); i != c.End(); i++)
   {
-    apps.Add (InstallPriv (*i));
+    if (IsLocalNode (*i))
+    {
+      apps.Add (InstallPriv (*i));
+    }
   }
   
   return apps;
@@ -77,6 +94,10 @@ VideoStreamClientHelper::SetAttribute(std::string name, const AttributeValue &va
 ApplicationContainer 
 VideoStreamClientHelper::Install (Ptr<Node> node) const
 {
+  if (!IsLocalNode (node))
+  {
+    return ApplicationContainer ();
+  }
   return ApplicationContainer (InstallPriv (node));
 }
 
@@ -84,7 +105,7 @@ ApplicationContainer
 VideoStreamClientHelper::Install (std::string nodeName) const
 {
   Ptr<Node> node = Names::Find<Node> (nodeName);
-  return ApplicationContainer (InstallPriv (node));
+  return Install (node);
 }
 
 ApplicationContainer 
@@ -93,7 +114,29 @@ VideoStreamClientHelper::Install (NodeContainer c) const
   ApplicationContainer apps;
   for (NodeContainer::Iterator i = c.Begin(); i != c.End(); i++)
   {
-    apps.Add (InstallPriv (*i));
+    if (IsLocalNode (*i))
+    {
+      apps.Add (InstallPriv (*i));
+    }
+  }
+  
+  return apps;
+}
+
+ApplicationContainer 
+VideoStreamClientHelper::Install (NodeContainer c, uint32_t clientsPerNode) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin(); i != c.End(); i++)
+  {
+    if (!IsLocalNode (*i))
+    {
+      continue;
+    }
+    for (uint32_t j = 0; j < clientsPerNode; j++)
+    {
+      apps.Add (InstallPriv (*i));
+    }
   }
   
   return apps;
@@ -14,6 +14,11 @@ namespace ns3 {
 
 /**
  * @brief Create a server application that sends the video frames to a client.
+ *
+ * In a distributed simulation every rank builds the whole topology, but
+ * applications are only created on the nodes of the local rank
+ * (Node::GetSystemId () == Simulator::GetSystemId ()); the others are
+ * skipped and missing from the returned container.
  */
 class VideoStreamServerHelper
 {
@@ -81,6 +86,12 @@ public:
 
 };
 
+/**
+ * @brief Create client applications that receive the video frames of a server.
+ *
+ * Like VideoStreamServerHelper, only nodes of the local rank of a
+ * distributed simulation get an application.
+ */
 class VideoStreamClientHelper
 {
 private:
@@ -153,6 +164,19 @@ public:
    */
   ApplicationContainer Install (NodeContainer c) const;
 
+  /**
+   * \param c the nodes
+   * \param clientsPerNode the number of applications on each node
+   *
+   * Create several VideoStreamClientApplications on each of the input nodes.
+   * The clients of a node share its address and are told apart by the
+   * server through their ports. They cannot join a multicast group, since
+   * only one socket of a node can bind the group port.
+   *
+   * \returns the applications created, clientsPerNode applications per input node.
+   */
+  ApplicationContainer Install (NodeContainer c, uint32_t clientsPerNode) const;
+
 };
 
 } // namespace ns3
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "video-stream-latency-histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+VideoStreamLatencyHistogram::VideoStreamLatencyHistogram ()
+  : m_counts (BUCKETS, 0),
+    m_count (0),
+    m_sumUs (0),
+    m_minUs (0),
+    m_maxUs (0)
+{
+}
+
+void
+VideoStreamLatencyHistogram::Add (Time latency)
+{
+  int64_t us = latency.GetMicroSeconds ();
+  uint64_t value = std::min<uint64_t> (std::max<int64_t> (us, 0), 0xffffffff);
+  m_counts[GetBucket (value)]++;
+  m_minUs = m_count == 0 ? value : std::min (m_minUs, value);
+  m_maxUs = m_count == 0 ? value : std::max (m_maxUs, value);
+  m_count++;
+  m_sumUs += value;
+}
+
+void
+VideoStreamLatencyHistogram::Merge (const VideoStreamLatencyHistogram &other)
+{
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < BUCKETS; i++)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+  m_minUs = m_count == 0 ? other.m_minUs : std::min (m_minUs, other.m_minUs);
+  m_maxUs = m_count == 0 ? other.m_maxUs : std::max (m_maxUs, other.m_maxUs);
+  m_count += other.m_count;
+  m_sumUs += other.m_sumUs;
+}
+
+uint64_t
+VideoStreamLatencyHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+Time
+VideoStreamLatencyHistogram::GetMean (void) const
+{
+  return m_count > 0 ? MicroSeconds (m_sumUs / m_count) : Time ();
+}
+
+Time
+VideoStreamLatencyHistogram::GetMax (void) const
+{
+  return MicroSeconds (m_maxUs);
+}
+
+Time
+VideoStreamLatencyHistogram::GetPercentile (double percent) const
+{
+  if (m_count == 0)
+    {
+      return Time ();
+    }
+  // Rank of the sample at the percentile, counted from 1
+  uint64_t rank = std::ceil (std::min (std::max (percent, 0.0), 100.0) / 100 * m_count);
+  rank = std::max<uint64_t> (rank, 1);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < BUCKETS; i++)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          uint64_t value = GetBucketLow (i) + GetBucketWidth (i) / 2;
+          return MicroSeconds (std::min (std::max (value, m_minUs), m_maxUs));
+        }
+    }
+  return MicroSeconds (m_maxUs);
+}
+
+uint32_t
+VideoStreamLatencyHistogram::GetBucket (uint64_t us)
+{
+  if (us < SUB_BUCKETS)
+    {
+      return us;
+    }
+  // The top SUB_BUCKET_BITS + 1 bits select the power of two and the bucket within it
+  uint32_t msb = 63 - __builtin_clzll (us);
+  uint32_t shift = msb - SUB_BUCKET_BITS;
+  return SUB_BUCKETS + shift * SUB_BUCKETS + ((us >> shift) - SUB_BUCKETS);
+}
+
+uint64_t
+VideoStreamLatencyHistogram::GetBucketLow (uint32_t bucket)
+{
+  if (bucket < SUB_BUCKETS)
+    {
+      return bucket;
+    }
+  uint32_t shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+  uint64_t top = SUB_BUCKETS + (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+  return top << shift;
+}
+
+uint64_t
+VideoStreamLatencyHistogram::GetBucketWidth (uint32_t bucket)
+{
+  if (bucket < SUB_BUCKETS)
+    {
+      return 1;
+    }
+  return static_cast<uint64_t> (1) << ((bucket - SUB_BUCKETS) / SUB_BUCKETS);
+}
+
+} // namespace ns3
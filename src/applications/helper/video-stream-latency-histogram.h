@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_LATENCY_HISTOGRAM_H
+#define VIDEO_STREAM_LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * @brief Fixed-size histogram of latencies with logarithmic buckets.
+ *
+ * Latencies are counted in microseconds. Below 32 us every microsecond
+ * has its own bucket; above, every power of two is split into 32 equal
+ * buckets, so a percentile is off by at most 1/64 of its value. Latencies
+ * above 2^32 us (about 71 minutes) are counted in the last bucket.
+ *
+ * The memory does not grow with the number of samples, so a histogram can
+ * be kept per client over millions of frames.
+ */
+class VideoStreamLatencyHistogram
+{
+public:
+  VideoStreamLatencyHistogram ();
+
+  /**
+   * Count one latency.
+   *
+   * \param latency the latency, negative values count as 0
+   */
+  void Add (Time latency);
+
+  /**
+   * Add the samples of another histogram to this one.
+   *
+   * \param other the other histogram
+   */
+  void Merge (const VideoStreamLatencyHistogram &other);
+
+  /**
+   * \returns the number of samples
+   */
+  uint64_t GetCount (void) const;
+
+  /**
+   * \returns the mean of the samples, exact up to the microsecond, 0 without samples
+   */
+  Time GetMean (void) const;
+
+  /**
+   * \returns the largest sample, 0 without samples
+   */
+  Time GetMax (void) const;
+
+  /**
+   * Get the latency below which a given percentage of the samples lie.
+   *
+   * \param percent the percentile, between 0 and 100
+   * \returns the middle of the bucket holding the percentile, bounded by
+   *          the smallest and largest sample, 0 without samples
+   */
+  Time GetPercentile (double percent) const;
+
+private:
+  static const uint32_t SUB_BUCKET_BITS = 5;                          //!< log2 of the buckets per power of two
+  static const uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;           //!< Buckets per power of two
+  static const uint32_t BUCKETS = SUB_BUCKETS * (32 - SUB_BUCKET_BITS + 1); //!< Buckets up to 2^32 us
+
+  /**
+   * \param us a latency in microseconds below 2^32
+   * \returns the bucket of the latency
+   */
+  static uint32_t GetBucket (uint64_t us);
+
+  /**
+   * \param bucket a bucket
+   * \returns the smallest latency of the bucket in microseconds
+   */
+  static uint64_t GetBucketLow (uint32_t bucket);
+
+  /**
+   * \param bucket a bucket
+   * \returns the number of microseconds the bucket spans
+   */
+  static uint64_t GetBucketWidth (uint32_t bucket);
+
+  std::vector<uint64_t> m_counts; //!< Samples per bucket
+  uint64_t m_count;               //!< Number of samples
+  uint64_t m_sumUs;               //!< Sum of the samples in microseconds
+  uint64_t m_minUs;               //!< Smallest sample in microseconds
+  uint64_t m_maxUs;               //!< Largest sample in microseconds
+};
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_LATENCY_HISTOGRAM_H */
@@ -0,0 +1,419 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "video-stream-stats-collector.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+VideoStreamStatsCollector::VideoStreamStatsCollector ()
+{
+}
+
+void
+VideoStreamStatsCollector::AddClient (Ptr<VideoStreamClient> client, std::string name)
+{
+  m_clients.push_back (ClientStats ());
+  ClientStats *stats = &m_clients.back ();
+  stats->m_name = name;
+  stats->m_firstTx = Time::Max ();
+  stats->m_firstFrame = Time::Max ();
+  stats->m_firstRx = Time::Max ();
+  stats->m_firstPlayout = Time::Max ();
+  stats->m_stalled = false;
+  stats->m_stalls = 0;
+  stats->m_ended = false;
+  stats->m_dataPackets = 0;
+  stats->m_refills = 0;
+  stats->m_requests = 0;
+  stats->m_goodBytes = 0;
+  stats->m_complete = 0;
+  stats->m_partial = 0;
+  stats->m_missing = 0;
+  stats->m_undecodable = 0;
+  stats->m_playoutRate = 1.0;
+
+  client->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&VideoStreamStatsCollector::Tx, stats));
+  client->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&VideoStreamStatsCollector::Rx, stats));
+  client->TraceConnectWithoutContext ("RetransmissionRequest", MakeBoundCallback (&VideoStreamStatsCollector::RetransmissionRequest, stats));
+  client->TraceConnectWithoutContext ("RetransmissionReceived", MakeBoundCallback (&VideoStreamStatsCollector::RetransmissionReceived, stats));
+  client->TraceConnectWithoutContext ("FrameComplete", MakeBoundCallback (&VideoStreamStatsCollector::FrameComplete, stats));
+  client->TraceConnectWithoutContext ("FrameUndecodable", MakeBoundCallback (&VideoStreamStatsCollector::FrameUndecodable, stats));
+  client->TraceConnectWithoutContext ("Playout", MakeBoundCallback (&VideoStreamStatsCollector::Playout, stats));
+  client->TraceConnectWithoutContext ("StallStart", MakeBoundCallback (&VideoStreamStatsCollector::StallStart, stats));
+  client->TraceConnectWithoutContext ("StallEnd", MakeBoundCallback (&VideoStreamStatsCollector::StallEnd, stats));
+  client->TraceConnectWithoutContext ("PlayoutState", MakeBoundCallback (&VideoStreamStatsCollector::PlayoutState, stats));
+  client->TraceConnectWithoutContext ("PlayoutRate", MakeBoundCallback (&VideoStreamStatsCollector::PlayoutRate, stats));
+  client->TraceConnectWithoutContext ("FrameLatency", MakeBoundCallback (&VideoStreamStatsCollector::FrameLatency, stats));
+}
+
+void
+VideoStreamStatsCollector::AddClients (ApplicationContainer apps)
+{
+  for (uint32_t i = 0; i < apps.GetN (); i++)
+    {
+      Ptr<VideoStreamClient> client = DynamicCast<VideoStreamClient> (apps.Get (i));
+      if (client)
+        {
+          std::ostringstream name;
+          name << "client" << i;
+          AddClient (client, name.str ());
+        }
+    }
+}
+
+std::string
+VideoStreamStatsCollector::GetCsvHeader (void)
+{
+  return "client,ttff,startupDelay,stalls,stallTime,rebufferRatio,goodput,retransOverhead,retransRequests,framesComplete,framesPartial,framesMissing,framesUndecodable,adaptedRatio";
+}
+
+std::string
+VideoStreamStatsCollector::GetLatencyCsvHeader (void)
+{
+  return "client,stage,frames,mean,p50,p90,p99,p99.9,max";
+}
+
+std::string
+VideoStreamStatsCollector::GetLatencyStageName (LatencyStage stage)
+{
+  switch (stage)
+    {
+    case LATENCY_FIRST_PACKET:
+      return "firstPacket";
+    case LATENCY_COMPLETE:
+      return "complete";
+    case LATENCY_REPAIR:
+      return "repair";
+    case LATENCY_PLAYOUT:
+      return "playout";
+    default:
+      NS_ABORT_MSG ("Unknown latency stage " << stage);
+    }
+  return "";
+}
+
+uint32_t
+VideoStreamStatsCollector::GetN (void) const
+{
+  return m_clients.size ();
+}
+
+VideoStreamStatsCollector::Metrics
+VideoStreamStatsCollector::GetMetrics (uint32_t i) const
+{
+  NS_ABORT_MSG_UNLESS (i < m_clients.size (), "No client " << i);
+  return Compute (m_clients[i]);
+}
+
+const VideoStreamLatencyHistogram &
+VideoStreamStatsCollector::GetLatency (uint32_t i, LatencyStage stage) const
+{
+  NS_ABORT_MSG_UNLESS (i < m_clients.size () && stage < LATENCY_STAGES, "No client " << i << " or stage " << stage);
+  return m_clients[i].m_latency[stage];
+}
+
+VideoStreamLatencyHistogram
+VideoStreamStatsCollector::GetLatency (LatencyStage stage) const
+{
+  NS_ABORT_MSG_UNLESS (stage < LATENCY_STAGES, "No stage " << stage);
+  VideoStreamLatencyHistogram all;
+  for (auto iter = m_clients.begin (); iter != m_clients.end (); iter++)
+    {
+      all.Merge (iter->m_latency[stage]);
+    }
+  return all;
+}
+
+VideoStreamStatsCollector::Metrics
+VideoStreamStatsCollector::GetMean (void) const
+{
+  Metrics mean = Metrics ();
+  mean.m_ttff = -1;
+  mean.m_startupDelay = -1;
+  if (m_clients.empty ())
+    {
+      return mean;
+    }
+  double ttffSum = 0;
+  uint32_t ttffCount = 0;
+  double startupSum = 0;
+  uint32_t startupCount = 0;
+  for (auto iter = m_clients.begin (); iter != m_clients.end (); iter++)
+    {
+      Metrics metrics = Compute (*iter);
+      if (metrics.m_ttff >= 0)
+        {
+          ttffSum += metrics.m_ttff;
+          ttffCount++;
+        }
+      if (metrics.m_startupDelay >= 0)
+        {
+          startupSum += metrics.m_startupDelay;
+          startupCount++;
+        }
+      mean.m_stalls += metrics.m_stalls;
+      mean.m_stallTime += metrics.m_stallTime;
+      mean.m_rebufferRatio += metrics.m_rebufferRatio;
+      mean.m_goodput += metrics.m_goodput;
+      mean.m_retransOverhead += metrics.m_retransOverhead;
+      mean.m_retransRequests += metrics.m_retransRequests;
+      mean.m_framesComplete += metrics.m_framesComplete;
+      mean.m_framesPartial += metrics.m_framesPartial;
+      mean.m_framesMissing += metrics.m_framesMissing;
+      mean.m_framesUndecodable += metrics.m_framesUndecodable;
+      mean.m_adaptedRatio += metrics.m_adaptedRatio;
+    }
+  double n = m_clients.size ();
+  mean.m_ttff = ttffCount > 0 ? ttffSum / ttffCount : -1;
+  mean.m_startupDelay = startupCount > 0 ? startupSum / startupCount : -1;
+  mean.m_stalls /= n;
+  mean.m_stallTime /= n;
+  mean.m_rebufferRatio /= n;
+  mean.m_goodput /= n;
+  mean.m_retransOverhead /= n;
+  mean.m_retransRequests /= n;
+  mean.m_framesComplete /= n;
+  mean.m_framesPartial /= n;
+  mean.m_framesMissing /= n;
+  mean.m_framesUndecodable /= n;
+  mean.m_adaptedRatio /= n;
+  return mean;
+}
+
+void
+VideoStreamStatsCollector::Write (std::ostream &os, bool header) const
+{
+  if (header)
+    {
+      os << GetCsvHeader () << std::endl;
+    }
+  for (auto iter = m_clients.begin (); iter != m_clients.end (); iter++)
+    {
+      Metrics metrics = Compute (*iter);
+      os << iter->m_name << ","
+         << metrics.m_ttff << ","
+         << metrics.m_startupDelay << ","
+         << metrics.m_stalls << ","
+         << metrics.m_stallTime << ","
+         << metrics.m_rebufferRatio << ","
+         << metrics.m_goodput << ","
+         << metrics.m_retransOverhead << ","
+         << metrics.m_retransRequests << ","
+         << metrics.m_framesComplete << ","
+         << metrics.m_framesPartial << ","
+         << metrics.m_framesMissing << ","
+         << metrics.m_framesUndecodable << ","
+         << metrics.m_adaptedRatio << std::endl;
+    }
+}
+
+void
+VideoStreamStatsCollector::WriteFile (std::string filename) const
+{
+  std::ofstream os (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << filename);
+  Write (os);
+}
+
+void
+VideoStreamStatsCollector::WriteLatency (std::ostream &os) const
+{
+  os << GetLatencyCsvHeader () << std::endl;
+  for (auto iter = m_clients.begin (); iter != m_clients.end (); iter++)
+    {
+      for (uint32_t stage = 0; stage < LATENCY_STAGES; stage++)
+        {
+          WriteLatencyLine (os, iter->m_name, static_cast<LatencyStage> (stage), iter->m_latency[stage]);
+        }
+    }
+  for (uint32_t stage = 0; stage < LATENCY_STAGES; stage++)
+    {
+      WriteLatencyLine (os, "all", static_cast<LatencyStage> (stage), GetLatency (static_cast<LatencyStage> (stage)));
+    }
+}
+
+void
+VideoStreamStatsCollector::WriteLatencyFile (std::string filename) const
+{
+  std::ofstream os (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << filename);
+  WriteLatency (os);
+}
+
+void
+VideoStreamStatsCollector::WriteLatencyLine (std::ostream &os, std::string name, LatencyStage stage, const VideoStreamLatencyHistogram &latency)
+{
+  os << name << ","
+     << GetLatencyStageName (stage) << ","
+     << latency.GetCount () << ","
+     << latency.GetMean ().GetSeconds () * 1000 << ","
+     << latency.GetPercentile (50).GetSeconds () * 1000 << ","
+     << latency.GetPercentile (90).GetSeconds () * 1000 << ","
+     << latency.GetPercentile (99).GetSeconds () * 1000 << ","
+     << latency.GetPercentile (99.9).GetSeconds () * 1000 << ","
+     << latency.GetMax ().GetSeconds () * 1000 << std::endl;
+}
+
+VideoStreamStatsCollector::Metrics
+VideoStreamStatsCollector::Compute (const ClientStats &stats)
+{
+  Metrics metrics;
+  metrics.m_ttff = -1;
+  if (stats.m_firstFrame != Time::Max () && stats.m_firstTx != Time::Max ())
+    {
+      metrics.m_ttff = (stats.m_firstFrame - stats.m_firstTx).GetSeconds ();
+    }
+  metrics.m_startupDelay = -1;
+  if (stats.m_firstPlayout != Time::Max () && stats.m_firstTx != Time::Max ())
+    {
+      metrics.m_startupDelay = (stats.m_firstPlayout - stats.m_firstTx).GetSeconds ();
+    }
+  // No frame is played during a stall, so an open stall lasts until now
+  // unless the stream ended, then playout ends with the last frame
+  Time stallTime = stats.m_stallTime;
+  Time playoutEnd = stats.m_lastPlayout;
+  if (stats.m_stalled && !stats.m_ended)
+    {
+      playoutEnd = std::max (Simulator::Now (), stats.m_stallStart);
+      stallTime += playoutEnd - stats.m_stallStart;
+    }
+  metrics.m_stalls = stats.m_stalls;
+  metrics.m_stallTime = stallTime.GetSeconds ();
+  metrics.m_rebufferRatio = 0;
+  if (stats.m_firstPlayout != Time::Max () && playoutEnd > stats.m_firstPlayout)
+    {
+      metrics.m_rebufferRatio = stallTime.GetSeconds () / (playoutEnd - stats.m_firstPlayout).GetSeconds ();
+    }
+  metrics.m_goodput = 0;
+  if (stats.m_firstRx != Time::Max () && stats.m_lastRx > stats.m_firstRx)
+    {
+      metrics.m_goodput = stats.m_goodBytes * 8 / (stats.m_lastRx - stats.m_firstRx).GetSeconds ();
+    }
+  metrics.m_retransOverhead = stats.m_dataPackets > 0 ? static_cast<double> (stats.m_refills) / stats.m_dataPackets : 0;
+  metrics.m_retransRequests = stats.m_requests;
+  metrics.m_framesComplete = stats.m_complete;
+  metrics.m_framesPartial = stats.m_partial;
+  metrics.m_framesMissing = stats.m_missing;
+  metrics.m_framesUndecodable = stats.m_undecodable;
+  // The rate changes when a frame is played and is reset to 1 by a stall, so an open change lasts until the last frame
+  Time adaptedTime = stats.m_adaptedTime;
+  if (stats.m_playoutRate != 1.0 && playoutEnd > stats.m_rateChange)
+    {
+      adaptedTime += playoutEnd - stats.m_rateChange;
+    }
+  metrics.m_adaptedRatio = 0;
+  if (stats.m_firstPlayout != Time::Max () && playoutEnd > stats.m_firstPlayout)
+    {
+      metrics.m_adaptedRatio = adaptedTime.GetSeconds () / (playoutEnd - stats.m_firstPlayout).GetSeconds ();
+    }
+  return metrics;
+}
+
+void
+VideoStreamStatsCollector::Tx (ClientStats *stats, Ptr<const Packet> packet)
+{
+  stats->m_firstTx = std::min (stats->m_firstTx, Simulator::Now ());
+}
+
+void
+VideoStreamStatsCollector::Rx (ClientStats *stats, Ptr<const Packet> packet, const Address &from)
+{
+  stats->m_firstRx = std::min (stats->m_firstRx, Simulator::Now ());
+  stats->m_lastRx = Simulator::Now ();
+  stats->m_dataPackets++;
+}
+
+void
+VideoStreamStatsCollector::RetransmissionRequest (ClientStats *stats, uint32_t seqNum)
+{
+  stats->m_requests++;
+}
+
+void
+VideoStreamStatsCollector::RetransmissionReceived (ClientStats *stats, uint32_t seqNum)
+{
+  stats->m_refills++;
+}
+
+void
+VideoStreamStatsCollector::FrameComplete (ClientStats *stats, uint32_t frameNum, uint32_t bytes)
+{
+  stats->m_firstFrame = std::min (stats->m_firstFrame, Simulator::Now ());
+  stats->m_goodBytes += bytes;
+}
+
+void
+VideoStreamStatsCollector::FrameUndecodable (ClientStats *stats, uint32_t frameNum)
+{
+  stats->m_undecodable++;
+}
+
+void
+VideoStreamStatsCollector::Playout (ClientStats *stats, uint32_t complete, uint32_t partial, uint32_t missing)
+{
+  stats->m_firstPlayout = std::min (stats->m_firstPlayout, Simulator::Now ());
+  stats->m_lastPlayout = Simulator::Now ();
+  stats->m_complete += complete;
+  stats->m_partial += partial;
+  stats->m_missing += missing;
+}
+
+void
+VideoStreamStatsCollector::StallStart (ClientStats *stats)
+{
+  // Nothing is left to wait for after the last frame
+  if (stats->m_ended)
+    {
+      return;
+    }
+  stats->m_stalled = true;
+  stats->m_stallStart = Simulator::Now ();
+  stats->m_stalls++;
+}
+
+void
+VideoStreamStatsCollector::StallEnd (ClientStats *stats, Time duration)
+{
+  stats->m_stalled = false;
+  stats->m_stallTime += duration;
+}
+
+void
+VideoStreamStatsCollector::PlayoutState (ClientStats *stats, VideoStreamClient::PlayoutState oldState, VideoStreamClient::PlayoutState newState)
+{
+  if (newState == VideoStreamClient::PLAYOUT_ENDED)
+    {
+      stats->m_ended = true;
+    }
+}
+
+void
+VideoStreamStatsCollector::PlayoutRate (ClientStats *stats, double oldRate, double newRate)
+{
+  if (stats->m_playoutRate != 1.0)
+    {
+      stats->m_adaptedTime += Simulator::Now () - stats->m_rateChange;
+    }
+  stats->m_playoutRate = newRate;
+  stats->m_rateChange = Simulator::Now ();
+}
+
+void
+VideoStreamStatsCollector::FrameLatency (ClientStats *stats, uint32_t frameNum, Time sent, Time firstRx, Time complete, Time lastOriginalRx)
+{
+  stats->m_latency[LATENCY_FIRST_PACKET].Add (firstRx - sent);
+  stats->m_latency[LATENCY_COMPLETE].Add (complete - sent);
+  if (complete > lastOriginalRx)
+    {
+      stats->m_latency[LATENCY_REPAIR].Add (complete - lastOriginalRx);
+    }
+  stats->m_latency[LATENCY_PLAYOUT].Add (Simulator::Now () - sent);
+}
+
+} // namespace ns3
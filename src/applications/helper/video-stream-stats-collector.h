@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_STATS_COLLECTOR_H
+#define VIDEO_STREAM_STATS_COLLECTOR_H
+
+#include <stdint.h>
+#include <deque>
+#include <ostream>
+#include <string>
+#include "ns3/application-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+#include "ns3/video-stream-client.h"
+#include "ns3/video-stream-latency-histogram.h"
+
+namespace ns3 {
+
+/**
+ * @brief Aggregate the trace sources of video stream clients into QoE metrics.
+ *
+ * For every client added the collector reports:
+ * - ttff: time from the first hello to the first complete frame
+ * - startupDelay: time from the first hello to the first frame played
+ * - stalls, stallTime: frames at which the buffer ran out during playout
+ *   and the time until playout resumed (an open stall counts until now,
+ *   a stall after the last frame of the stream is not counted)
+ * - rebufferRatio: stall time over the time since playout started
+ * - goodput: bytes of complete frames per second of reception
+ * - retransOverhead: refilled (retransmitted) packets over all data packets received
+ * - frames played complete, partial and missing, and retransmission requests
+ * - adaptedRatio: time played at a playout rate other than 1 over the time
+ *   since playout started (AdaptivePlayout)
+ *
+ * Write () prints one CSV line per client, so runs can be compared
+ * without parsing the log output.
+ *
+ * The latency of every complete frame is counted in a
+ * VideoStreamLatencyHistogram per client and stage, measured from the
+ * earliest send timestamp of its packets:
+ * - firstPacket: to the arrival of its first packet
+ * - complete: to its complete reassembly
+ * - repair: from the last packet that was not a retransmission to the
+ *   completion, only for frames completed by a retransmission
+ * - playout: to the time it is played
+ *
+ * WriteLatency () prints the mean and the 50th, 90th, 99th and 99.9th
+ * percentiles of every stage per client and for all clients together.
+ */
+class VideoStreamStatsCollector
+{
+public:
+  /**
+   * QoE metrics of one client, or their mean over all clients.
+   */
+  struct Metrics
+  {
+    double m_ttff;            //!< Seconds to the first complete frame, -1 if none
+    double m_startupDelay;    //!< Seconds to the first frame played, -1 if none
+    double m_stalls;
+    double m_stallTime;       //!< Seconds
+    double m_rebufferRatio;
+    double m_goodput;         //!< bit/s
+    double m_retransOverhead;
+    double m_retransRequests;
+    double m_framesComplete;
+    double m_framesPartial;
+    double m_framesMissing;
+    double m_framesUndecodable; //!< Complete frames whose reference frame could not be decoded
+    double m_adaptedRatio;    //!< Fraction of the playout time at a slowed or sped up rate
+  };
+
+  /**
+   * Stage of the frame latency histograms.
+   */
+  enum LatencyStage
+  {
+    LATENCY_FIRST_PACKET, //!< Send to first packet arrival
+    LATENCY_COMPLETE,     //!< Send to complete reassembly
+    LATENCY_REPAIR,       //!< Last original arrival to completion, frames repaired by retransmission
+    LATENCY_PLAYOUT,      //!< Send to playout
+    LATENCY_STAGES        //!< Number of stages
+  };
+
+  VideoStreamStatsCollector ();
+
+  /**
+   * Connect to the trace sources of a client.
+   *
+   * \param client the client
+   * \param name the name of the client in the output
+   */
+  void AddClient (Ptr<VideoStreamClient> client, std::string name);
+
+  /**
+   * Connect to every VideoStreamClient of a container, named after their index.
+   *
+   * \param apps the applications
+   */
+  void AddClients (ApplicationContainer apps);
+
+  /**
+   * \returns the number of clients added
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * \param i the index of the client
+   * \returns the metrics of the client
+   */
+  Metrics GetMetrics (uint32_t i) const;
+
+  /**
+   * \returns the mean of the metrics over all clients, the TTFF and the
+   * startup delay over the clients that completed or played a frame
+   */
+  Metrics GetMean (void) const;
+
+  /**
+   * \param i the index of the client
+   * \param stage the latency stage
+   * \returns the frame latencies of the client at the stage
+   */
+  const VideoStreamLatencyHistogram &GetLatency (uint32_t i, LatencyStage stage) const;
+
+  /**
+   * \param stage the latency stage
+   * \returns the frame latencies of all clients at the stage
+   */
+  VideoStreamLatencyHistogram GetLatency (LatencyStage stage) const;
+
+  /**
+   * \param stage the latency stage
+   * \returns the name of the stage in the latency output
+   */
+  static std::string GetLatencyStageName (LatencyStage stage);
+
+  /**
+   * \returns the CSV header line matching Write
+   */
+  static std::string GetCsvHeader (void);
+
+  /**
+   * \returns the CSV header line matching WriteLatency
+   */
+  static std::string GetLatencyCsvHeader (void);
+
+  /**
+   * Write the CSV header and one line per client.
+   *
+   * \param os the output stream
+   * \param header whether to write the header, off to append the clients
+   *        of another rank of a distributed simulation
+   */
+  void Write (std::ostream &os, bool header = true) const;
+
+  /**
+   * Write the statistics to a file.
+   *
+   * \param filename the file name
+   */
+  void WriteFile (std::string filename) const;
+
+  /**
+   * Write the CSV header, one line per client and stage and one line per
+   * stage for all clients, named "all". Latencies are in milliseconds.
+   *
+   * \param os the output stream
+   */
+  void WriteLatency (std::ostream &os) const;
+
+  /**
+   * Write the frame latencies to a file.
+   *
+   * \param filename the file name
+   */
+  void WriteLatencyFile (std::string filename) const;
+
+private:
+  /**
+   * Statistics of one client.
+   */
+  struct ClientStats
+  {
+    std::string m_name;
+    Time m_firstTx;          //!< First packet sent by the client
+    Time m_firstFrame;       //!< First frame completed
+    Time m_firstRx;          //!< First packet received
+    Time m_lastRx;           //!< Last packet received
+    Time m_firstPlayout;     //!< First frame played
+    Time m_lastPlayout;      //!< Last frame played
+    Time m_stallStart;       //!< Start of the open stall
+    bool m_stalled;
+    uint32_t m_stalls;
+    Time m_stallTime;        //!< Duration of the closed stalls
+    bool m_ended;            //!< Whether the last frame of the stream was played
+    uint64_t m_dataPackets;  //!< Packets of the stream received
+    uint64_t m_refills;      //!< Packets received after their gap was detected
+    uint64_t m_requests;     //!< Sequence numbers requested again
+    uint64_t m_goodBytes;    //!< Bytes of complete frames
+    uint64_t m_complete;
+    uint64_t m_partial;
+    uint64_t m_missing;
+    uint64_t m_undecodable;
+    double m_playoutRate;    //!< Current playout rate
+    Time m_rateChange;       //!< Last change of the playout rate
+    Time m_adaptedTime;      //!< Time played at a rate other than 1, up to m_rateChange
+    VideoStreamLatencyHistogram m_latency[LATENCY_STAGES]; //!< Frame latencies by stage
+  };
+
+  static Metrics Compute (const ClientStats &stats);
+
+  static void Tx (ClientStats *stats, Ptr<const Packet> packet);
+  static void Rx (ClientStats *stats, Ptr<const Packet> packet, const Address &from);
+  static void RetransmissionRequest (ClientStats *stats, uint32_t seqNum);
+  static void RetransmissionReceived (ClientStats *stats, uint32_t seqNum);
+  static void FrameComplete (ClientStats *stats, uint32_t frameNum, uint32_t bytes);
+  static void FrameUndecodable (ClientStats *stats, uint32_t frameNum);
+  static void Playout (ClientStats *stats, uint32_t complete, uint32_t partial, uint32_t missing);
+  static void StallStart (ClientStats *stats);
+  static void StallEnd (ClientStats *stats, Time duration);
+  static void PlayoutState (ClientStats *stats, VideoStreamClient::PlayoutState oldState, VideoStreamClient::PlayoutState newState);
+  static void PlayoutRate (ClientStats *stats, double oldRate, double newRate);
+  static void FrameLatency (ClientStats *stats, uint32_t frameNum, Time sent, Time firstRx, Time complete, Time lastOriginalRx);
+  static void WriteLatencyLine (std::ostream &os, std::string name, LatencyStage stage, const VideoStreamLatencyHistogram &latency);
+
+  std::deque<ClientStats> m_clients; //!< Stats of each client, stable addresses for the bound callbacks
+};
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_STATS_COLLECTOR_H */
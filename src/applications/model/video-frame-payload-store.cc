@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-frame-payload-store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoFramePayloadStore");
+
+    VideoFramePayloadStore::VideoFramePayloadStore()
+        : m_mode(PAYLOAD_STAMPED),
+          m_maxPacketSize(1400),
+          m_capacity(64),
+          m_framesBuilt(0)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    void
+    VideoFramePayloadStore::Setup(PayloadMode mode, uint32_t maxPacketSize, uint32_t capacity)
+    {
+        NS_LOG_FUNCTION(this << mode << maxPacketSize << capacity);
+        m_mode = mode;
+        m_maxPacketSize = maxPacketSize;
+        m_capacity = std::max<uint32_t>(capacity, 1);
+        Clear();
+    }
+
+    Ptr<Packet>
+    VideoFramePayloadStore::GetPacket(uint32_t frameNum, uint32_t frameSize, uint32_t offset, uint32_t size)
+    {
+        if (m_mode == PAYLOAD_VIRTUAL)
+        {
+            return Create<Packet>(size);
+        }
+        if (m_mode == PAYLOAD_COPY)
+        {
+            std::vector<uint8_t> dataBuffer(size);
+            snprintf((char *)dataBuffer.data(), size, "%u", frameNum);
+            return Create<Packet>(dataBuffer.data(), size);
+        }
+
+        auto iter = m_frames.find(frameNum);
+        if (iter == m_frames.end())
+        {
+            if (m_frames.size() >= m_capacity)
+            {
+                m_frames.erase(m_lru.back());
+                m_lru.pop_back();
+            }
+            m_lru.push_front(frameNum);
+            iter = m_frames.emplace(frameNum, FrameEntry(BuildFrame(frameNum, frameSize), m_lru.begin())).first;
+        }
+        else if (iter->second.second != m_lru.begin())
+        {
+            m_lru.splice(m_lru.begin(), m_lru, iter->second.second);
+        }
+        return iter->second.first->CreateFragment(offset, size);
+    }
+
+    Ptr<Packet>
+    VideoFramePayloadStore::BuildFrame(uint32_t frameNum, uint32_t frameSize)
+    {
+        NS_LOG_FUNCTION(this << frameNum << frameSize);
+        std::vector<uint8_t> dataBuffer(frameSize, 0);
+        for (uint32_t offset = 0; offset < frameSize; offset += m_maxPacketSize)
+        {
+            snprintf((char *)&dataBuffer[offset], std::min(m_maxPacketSize, frameSize - offset), "%u", frameNum);
+        }
+        m_framesBuilt++;
+        return Create<Packet>(dataBuffer.data(), frameSize);
+    }
+
+    uint64_t
+    VideoFramePayloadStore::GetFramesBuilt(void) const
+    {
+        return m_framesBuilt;
+    }
+
+    void
+    VideoFramePayloadStore::Clear(void)
+    {
+        m_frames.clear();
+        m_lru.clear();
+    }
+
+} // namespace ns3
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_FRAME_PAYLOAD_STORE_H
+#define VIDEO_FRAME_PAYLOAD_STORE_H
+
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+#include <list>
+#include <unordered_map>
+
+namespace ns3
+{
+
+    /**
+     * @brief Payloads of the video frames, shared by every client of a server.
+     *
+     * In PAYLOAD_STAMPED mode the payload of a frame is built once and every
+     * packet of it, for every client and every retransmission, is a
+     * copy-on-write fragment of that single buffer. In PAYLOAD_VIRTUAL mode
+     * packets carry a zero-filled virtual payload that allocates no memory.
+     * PAYLOAD_COPY keeps one private buffer per packet and only exists as a
+     * baseline to compare against.
+     */
+    class VideoFramePayloadStore
+    {
+    public:
+        enum PayloadMode
+        {
+            PAYLOAD_COPY,    //!< Allocate and fill a buffer for every packet
+            PAYLOAD_STAMPED, //!< Frame number stamped once per frame, fragments shared
+            PAYLOAD_VIRTUAL  //!< Zero-filled virtual payload, nothing allocated
+        };
+
+        VideoFramePayloadStore();
+
+        /**
+         * @brief Configure the store.
+         *
+         * @param mode how payloads are built
+         * @param maxPacketSize the payload size of a full packet
+         * @param capacity the number of frame payloads kept, least recently used ones are dropped first
+         */
+        void Setup(PayloadMode mode, uint32_t maxPacketSize, uint32_t capacity);
+
+        /**
+         * @brief Get the payload of one packet of a frame.
+         *
+         * @param frameNum the frame number
+         * @param frameSize the number of bytes of the frame
+         * @param offset the offset of the packet inside the frame
+         * @param size the number of payload bytes of the packet
+         * @return a packet holding the payload
+         */
+        Ptr<Packet> GetPacket(uint32_t frameNum, uint32_t frameSize, uint32_t offset, uint32_t size);
+
+        /**
+         * @return the number of frame payloads built so far
+         */
+        uint64_t GetFramesBuilt(void) const;
+
+        /**
+         * @brief Drop every cached frame.
+         */
+        void Clear(void);
+
+    private:
+        /**
+         * @brief Build a frame payload with the frame number at the start of
+         * every packet.
+         */
+        Ptr<Packet> BuildFrame(uint32_t frameNum, uint32_t frameSize);
+
+        typedef std::pair<Ptr<Packet>, std::list<uint32_t>::iterator> FrameEntry;
+
+        PayloadMode m_mode;
+        uint32_t m_maxPacketSize;
+        uint32_t m_capacity; //!< Maximum number of cached frames
+        uint64_t m_framesBuilt;
+        std::list<uint32_t> m_lru; //!< Cached frame numbers, most recently used first
+        std::unordered_map<uint32_t, FrameEntry> m_frames; //!< Frame number -> frame payload
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_FRAME_PAYLOAD_STORE_H */
@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-frame-reassembly.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoFrameReassembly");
+
+    VideoFrameReassembly::VideoFrameReassembly()
+        : m_packetsPerFrame(0),
+          m_window(0),
+          m_words(0),
+          m_playoutFrame(0),
+          m_duplicates(0),
+          m_recovered(0),
+          m_blocks(0),
+          m_parityWords(0)
+    {
+    }
+
+    void
+    VideoFrameReassembly::Setup(uint32_t packetsPerFrame, uint32_t window, const VideoStreamFec &fec, uint32_t firstFrame)
+    {
+        NS_LOG_FUNCTION(this << packetsPerFrame << window << firstFrame);
+        m_packetsPerFrame = packetsPerFrame;
+        m_window = window;
+        m_words = (packetsPerFrame + 63) / 64;
+        m_playoutFrame = firstFrame;
+        m_duplicates = 0;
+        m_recovered = 0;
+        m_fec = fec;
+        m_blocks = fec.IsEnabled() ? fec.GetBlocksPerFrame(packetsPerFrame) : 0;
+        m_parityWords = (m_blocks * fec.GetParityPerBlock() + 63) / 64;
+        // 슬롯이 비어 있음을 나타내기 위해 window 밖의, 같은 슬롯에 들어가는 프레임 번호로 초기화
+        m_frameNum.assign(window, 0);
+        for (uint32_t slot = 0; slot < window; slot++)
+        {
+            uint32_t frameNum = firstFrame + window + slot;
+            m_frameNum[frameNum % window] = frameNum;
+        }
+        m_packets.assign(window, 0);
+        m_received.assign(window, 0);
+        m_bytes.assign(window, 0);
+        m_bitmaps.assign(static_cast<size_t>(window) * m_words, 0);
+        m_blockSource.assign(static_cast<size_t>(window) * m_blocks, 0);
+        m_blockParity.assign(static_cast<size_t>(window) * m_blocks, 0);
+        m_parityBitmaps.assign(static_cast<size_t>(window) * m_parityWords, 0);
+    }
+
+    bool
+    VideoFrameReassembly::AddPacket(uint32_t frameNum, uint32_t index, uint32_t framePackets, uint32_t bytes)
+    {
+        if (!IsPending(frameNum) || framePackets > m_packetsPerFrame || index >= framePackets)
+        {
+            return false;
+        }
+
+        uint32_t slot = GetSlot(frameNum, framePackets);
+        uint64_t &word = m_bitmaps[static_cast<size_t>(slot) * m_words + index / 64];
+        uint64_t bit = static_cast<uint64_t>(1) << (index % 64);
+        if (word & bit)
+        {
+            m_duplicates++;
+            return false;
+        }
+        word |= bit;
+        m_received[slot]++;
+        m_bytes[slot] += bytes;
+
+        if (m_blocks > 0)
+        {
+            uint32_t block = m_fec.GetBlock(index, framePackets);
+            m_blockSource[static_cast<size_t>(slot) * m_blocks + block]++;
+            TryRecover(slot, block, bytes);
+        }
+        return true;
+    }
+
+    bool
+    VideoFrameReassembly::AddParity(uint32_t frameNum, uint32_t parityIndex, uint32_t framePackets, uint32_t bytes)
+    {
+        if (m_blocks == 0 || !IsPending(frameNum) || framePackets > m_packetsPerFrame)
+        {
+            return false;
+        }
+        uint32_t block = parityIndex / m_fec.GetParityPerBlock();
+        if (block >= m_fec.GetBlocksPerFrame(framePackets))
+        {
+            return false;
+        }
+
+        uint32_t slot = GetSlot(frameNum, framePackets);
+        uint64_t &word = m_parityBitmaps[static_cast<size_t>(slot) * m_parityWords + parityIndex / 64];
+        uint64_t bit = static_cast<uint64_t>(1) << (parityIndex % 64);
+        if (word & bit)
+        {
+            m_duplicates++;
+            return false;
+        }
+        word |= bit;
+        m_blockParity[static_cast<size_t>(slot) * m_blocks + block]++;
+        TryRecover(slot, block, bytes);
+        return true;
+    }
+
+    bool
+    VideoFrameReassembly::HasPacket(uint32_t frameNum, uint32_t index) const
+    {
+        uint32_t slot = frameNum % m_window;
+        if (!IsPending(frameNum) || m_frameNum[slot] != frameNum || index >= m_packetsPerFrame)
+        {
+            return false;
+        }
+        uint64_t bit = static_cast<uint64_t>(1) << (index % 64);
+        return (m_bitmaps[static_cast<size_t>(slot) * m_words + index / 64] & bit) != 0;
+    }
+
+    VideoFrameReassembly::FrameState
+    VideoFrameReassembly::GetFrameState(uint32_t frameNum) const
+    {
+        if (!IsPending(frameNum))
+        {
+            return FRAME_MISSING;
+        }
+        uint32_t slot = frameNum % m_window;
+        if (m_frameNum[slot] != frameNum || m_received[slot] == 0)
+        {
+            return FRAME_MISSING;
+        }
+        return m_received[slot] == m_packets[slot] ? FRAME_COMPLETE : FRAME_PARTIAL;
+    }
+
+    uint32_t
+    VideoFrameReassembly::GetFramePackets(uint32_t frameNum) const
+    {
+        uint32_t slot = frameNum % m_window;
+        if (!IsPending(frameNum) || m_frameNum[slot] != frameNum)
+        {
+            return 0;
+        }
+        return m_packets[slot];
+    }
+
+    uint32_t
+    VideoFrameReassembly::GetFrameBytes(uint32_t frameNum) const
+    {
+        uint32_t slot = frameNum % m_window;
+        if (!IsPending(frameNum) || m_frameNum[slot] != frameNum)
+        {
+            return 0;
+        }
+        return m_bytes[slot];
+    }
+
+    bool
+    VideoFrameReassembly::IsPending(uint32_t frameNum) const
+    {
+        return frameNum >= m_playoutFrame && frameNum < m_playoutFrame + m_window;
+    }
+
+    VideoFrameReassembly::FrameState
+    VideoFrameReassembly::PopFrame(void)
+    {
+        FrameState state = GetFrameState(m_playoutFrame);
+        // 재생한 프레임의 슬롯은 window 뒤의 프레임이 쓰도록 비운다
+        ResetSlot(m_playoutFrame % m_window, m_playoutFrame + m_window);
+        m_playoutFrame++;
+        return state;
+    }
+
+    uint32_t
+    VideoFrameReassembly::GetPlayoutFrame(void) const
+    {
+        return m_playoutFrame;
+    }
+
+    uint64_t
+    VideoFrameReassembly::GetDuplicates(void) const
+    {
+        return m_duplicates;
+    }
+
+    uint64_t
+    VideoFrameReassembly::GetRecovered(void) const
+    {
+        return m_recovered;
+    }
+
+    uint32_t
+    VideoFrameReassembly::GetSlot(uint32_t frameNum, uint32_t framePackets)
+    {
+        uint32_t slot = frameNum % m_window;
+        if (m_frameNum[slot] != frameNum)
+        {
+            ResetSlot(slot, frameNum);
+        }
+        m_packets[slot] = framePackets;
+        return slot;
+    }
+
+    void
+    VideoFrameReassembly::ResetSlot(uint32_t slot, uint32_t frameNum)
+    {
+        m_frameNum[slot] = frameNum;
+        m_packets[slot] = 0;
+        m_received[slot] = 0;
+        m_bytes[slot] = 0;
+        std::fill(m_bitmaps.begin() + static_cast<size_t>(slot) * m_words, m_bitmaps.begin() + static_cast<size_t>(slot + 1) * m_words, 0);
+        std::fill(m_blockSource.begin() + static_cast<size_t>(slot) * m_blocks, m_blockSource.begin() + static_cast<size_t>(slot + 1) * m_blocks, 0);
+        std::fill(m_blockParity.begin() + static_cast<size_t>(slot) * m_blocks, m_blockParity.begin() + static_cast<size_t>(slot + 1) * m_blocks, 0);
+        std::fill(m_parityBitmaps.begin() + static_cast<size_t>(slot) * m_parityWords, m_parityBitmaps.begin() + static_cast<size_t>(slot + 1) * m_parityWords, 0);
+    }
+
+    void
+    VideoFrameReassembly::TryRecover(uint32_t slot, uint32_t block, uint32_t bytes)
+    {
+        size_t b = static_cast<size_t>(slot) * m_blocks + block;
+        uint32_t length = m_fec.GetBlockLength(block, m_packets[slot]);
+        // 받은 소스와 패리티 패킷 수가 블록 길이에 도달하면 나머지를 복원할 수 있다
+        if (m_blockSource[b] >= length || m_blockSource[b] + m_blockParity[b] < length)
+        {
+            return;
+        }
+
+        uint32_t start = m_fec.GetBlockStart(block, m_packets[slot]);
+        for (uint32_t index = start; index < start + length; index++)
+        {
+            uint64_t &word = m_bitmaps[static_cast<size_t>(slot) * m_words + index / 64];
+            uint64_t bit = static_cast<uint64_t>(1) << (index % 64);
+            if (!(word & bit))
+            {
+                word |= bit;
+                m_received[slot]++;
+                m_bytes[slot] += bytes;
+                m_recovered++;
+            }
+        }
+        m_blockSource[b] = length;
+    }
+
+} // namespace ns3
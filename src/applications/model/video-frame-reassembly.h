@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_FRAME_REASSEMBLY_H
+#define VIDEO_FRAME_REASSEMBLY_H
+
+#include "ns3/video-stream-fec.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * @brief Per-frame packet bitmaps of the frames a client has not played yet.
+     *
+     * Frames live in a ring of `window` slots starting at the playout frame.
+     * Each slot keeps one bit per packet of the frame, so duplicates are
+     * detected and a frame is only complete once every packet arrived.
+     * Frames may have fewer packets than the largest one; the number of
+     * packets of a frame is learned from its first packet.
+     *
+     * With FEC the source and parity packets of every block are counted,
+     * parity packets with one bit per parity index so repeats are ignored,
+     * and the missing source packets of a block are marked as recovered as
+     * soon as enough packets of the block arrived.
+     */
+    class VideoFrameReassembly
+    {
+    public:
+        enum FrameState
+        {
+            FRAME_MISSING,  //!< No packet of the frame arrived
+            FRAME_PARTIAL,  //!< Some packets of the frame arrived
+            FRAME_COMPLETE  //!< Every packet of the frame arrived
+        };
+
+        VideoFrameReassembly();
+
+        /**
+         * @brief Configure the reassembly and drop every frame.
+         *
+         * @param packetsPerFrame the largest number of packets of a frame
+         * @param window the number of frames tracked ahead of the playout frame
+         * @param fec the FEC block layout of the stream
+         * @param firstFrame the first frame to be played
+         */
+        void Setup(uint32_t packetsPerFrame, uint32_t window, const VideoStreamFec &fec = VideoStreamFec(), uint32_t firstFrame = 0);
+
+        /**
+         * @brief Record a received packet.
+         *
+         * @param frameNum the frame of the packet
+         * @param index the index of the packet inside the frame
+         * @param framePackets the number of packets of the frame
+         * @param bytes the payload size of the packet
+         * @return false if the packet is a duplicate, already played or beyond the window
+         */
+        bool AddPacket(uint32_t frameNum, uint32_t index, uint32_t framePackets, uint32_t bytes);
+
+        /**
+         * @brief Record a received parity packet.
+         *
+         * @param frameNum the frame of the packet
+         * @param parityIndex the index of the parity packet inside the frame
+         * @param framePackets the number of source packets of the frame
+         * @param bytes the payload size of the packet
+         * @return false if FEC is disabled, the packet is a duplicate, the frame
+         * is already played or beyond the window
+         */
+        bool AddParity(uint32_t frameNum, uint32_t parityIndex, uint32_t framePackets, uint32_t bytes);
+
+        /**
+         * @param frameNum the frame number
+         * @param index the index of the packet inside the frame
+         * @return true if the packet was received or recovered
+         */
+        bool HasPacket(uint32_t frameNum, uint32_t index) const;
+
+        /**
+         * @param frameNum the frame number
+         * @return the number of packets of the frame, 0 if none of them arrived yet
+         */
+        uint32_t GetFramePackets(uint32_t frameNum) const;
+
+        /**
+         * @param frameNum the frame number
+         * @return the state of the frame
+         */
+        FrameState GetFrameState(uint32_t frameNum) const;
+
+        /**
+         * @param frameNum the frame number
+         * @return the number of payload bytes received for the frame
+         */
+        uint32_t GetFrameBytes(uint32_t frameNum) const;
+
+        /**
+         * @brief Whether a frame has not been played yet, i.e. it can still become decodable.
+         *
+         * @param frameNum the frame number
+         * @return true if the frame is at or after the playout frame
+         */
+        bool IsPending(uint32_t frameNum) const;
+
+        /**
+         * @brief Play the next frame and free its slot.
+         *
+         * @return the state the frame was played in
+         */
+        FrameState PopFrame(void);
+
+        /**
+         * @return the next frame to be played
+         */
+        uint32_t GetPlayoutFrame(void) const;
+
+        /**
+         * @return the number of duplicate packets rejected
+         */
+        uint64_t GetDuplicates(void) const;
+
+        /**
+         * @return the number of source packets recovered from parity packets
+         */
+        uint64_t GetRecovered(void) const;
+
+    private:
+        /**
+         * @brief Claim the slot of a frame, clearing it if it held an older frame.
+         *
+         * @param frameNum the frame number
+         * @param framePackets the number of packets of the frame
+         * @return the slot
+         */
+        uint32_t GetSlot(uint32_t frameNum, uint32_t framePackets);
+
+        /**
+         * @brief Clear a slot.
+         *
+         * @param slot the slot
+         * @param frameNum the frame number the slot is assigned to
+         */
+        void ResetSlot(uint32_t slot, uint32_t frameNum);
+
+        /**
+         * @brief Mark the missing source packets of a block as received if
+         * enough source and parity packets of it arrived.
+         *
+         * @param slot the slot of the frame
+         * @param block the block of the frame
+         * @param bytes the payload size credited to each recovered packet
+         */
+        void TryRecover(uint32_t slot, uint32_t block, uint32_t bytes);
+
+        uint32_t m_packetsPerFrame;
+        uint32_t m_window;
+        uint32_t m_words;         //!< 64-bit words per frame bitmap
+        uint32_t m_playoutFrame;  //!< Next frame to be played
+        uint64_t m_duplicates;
+        uint64_t m_recovered;
+        VideoStreamFec m_fec;     //!< FEC block layout
+        uint32_t m_blocks;        //!< FEC blocks of the largest frame, 0 without FEC
+        uint32_t m_parityWords;   //!< 64-bit words per parity bitmap
+
+        std::vector<uint32_t> m_frameNum;  //!< Frame number held by each slot
+        std::vector<uint32_t> m_packets;   //!< Packets of the frame per slot, 0 if unknown
+        std::vector<uint32_t> m_received;  //!< Packets received per slot
+        std::vector<uint32_t> m_bytes;     //!< Bytes received per slot
+        std::vector<uint64_t> m_bitmaps;   //!< m_words bitmap words per slot
+        std::vector<uint16_t> m_blockSource; //!< Source packets received per block, m_blocks per slot
+        std::vector<uint16_t> m_blockParity; //!< Parity packets received per block, m_blocks per slot
+        std::vector<uint64_t> m_parityBitmaps; //!< m_parityWords bitmap words of received parity indexes per slot
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_FRAME_REASSEMBLY_H */
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "video-frame-trace.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoFrameTrace");
+
+    VideoFrameTrace::VideoFrameTrace()
+        : m_chunkFrames(1024),
+          m_cacheChunks(4),
+          m_frameCount(0),
+          m_maxFrameSize(0),
+          m_totalBytes(0)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    void
+    VideoFrameTrace::Open(std::string filename, uint32_t chunkFrames, uint32_t cacheChunks)
+    {
+        NS_LOG_FUNCTION(this << filename << chunkFrames << cacheChunks);
+        Close();
+        m_filename = filename;
+        m_chunkFrames = std::max<uint32_t>(chunkFrames, 1);
+        m_cacheChunks = std::max<uint32_t>(cacheChunks, 1);
+        m_file.open(filename.c_str());
+        NS_ABORT_MSG_UNLESS(m_file.is_open(), "Cannot open video trace " << filename);
+
+        // 한 번 훑으면서 청크마다 시작 위치만 기록하고 프레임 내용은 버린다
+        std::string line;
+        std::streamoff offset = m_file.tellg();
+        Frame frame;
+        uint32_t lastRef = NO_REF;
+        while (std::getline(m_file, line))
+        {
+            if (ParseLine(line, frame))
+            {
+                if (m_frameCount % m_chunkFrames == 0)
+                {
+                    m_chunkOffsets.push_back(offset);
+                    m_chunkRefs.push_back(lastRef);
+                }
+                if (frame.m_type != VideoStreamFrameHeader::FRAME_B)
+                {
+                    lastRef = m_frameCount;
+                }
+                m_frameCount++;
+                m_maxFrameSize = std::max(m_maxFrameSize, frame.m_size);
+                m_totalBytes += frame.m_size;
+            }
+            offset = m_file.tellg();
+        }
+        m_file.clear();
+        NS_ABORT_MSG_IF(m_frameCount == 0, "Video trace " << filename << " has no frames");
+        NS_LOG_INFO("Video trace " << filename << ": " << m_frameCount << " frames, largest " << m_maxFrameSize << " bytes");
+    }
+
+    bool
+    VideoFrameTrace::IsOpen(void) const
+    {
+        return m_frameCount > 0;
+    }
+
+    void
+    VideoFrameTrace::Close(void)
+    {
+        if (m_file.is_open())
+        {
+            m_file.close();
+        }
+        m_frameCount = 0;
+        m_maxFrameSize = 0;
+        m_totalBytes = 0;
+        m_chunkOffsets.clear();
+        m_chunkRefs.clear();
+        m_chunks.clear();
+        m_lru.clear();
+    }
+
+    uint32_t
+    VideoFrameTrace::GetFrameCount(void) const
+    {
+        return m_frameCount;
+    }
+
+    uint32_t
+    VideoFrameTrace::GetMaxFrameSize(void) const
+    {
+        return m_maxFrameSize;
+    }
+
+    double
+    VideoFrameTrace::GetMeanFrameSize(void) const
+    {
+        return m_frameCount > 0 ? static_cast<double>(m_totalBytes) / m_frameCount : 0.0;
+    }
+
+    void
+    VideoFrameTrace::SetCacheChunks(uint32_t cacheChunks)
+    {
+        m_cacheChunks = std::max<uint32_t>(cacheChunks, 1);
+        while (m_chunks.size() > m_cacheChunks)
+        {
+            m_chunks.erase(m_lru.back());
+            m_lru.pop_back();
+        }
+    }
+
+    VideoFrameTrace::Frame
+    VideoFrameTrace::GetFrame(uint32_t frameNum)
+    {
+        NS_ASSERT(IsOpen());
+        frameNum %= m_frameCount;
+        uint32_t chunk = frameNum / m_chunkFrames;
+        auto iter = m_chunks.find(chunk);
+        if (iter == m_chunks.end())
+        {
+            if (m_chunks.size() >= m_cacheChunks)
+            {
+                m_chunks.erase(m_lru.back());
+                m_lru.pop_back();
+            }
+            m_lru.push_front(chunk);
+            iter = m_chunks.emplace(chunk, ChunkEntry(ReadChunk(chunk), m_lru.begin())).first;
+        }
+        else if (iter->second.second != m_lru.begin())
+        {
+            m_lru.splice(m_lru.begin(), m_lru, iter->second.second);
+        }
+        return iter->second.first[frameNum % m_chunkFrames];
+    }
+
+    bool
+    VideoFrameTrace::ParseLine(const std::string &line, Frame &frame)
+    {
+        std::istringstream stream(line);
+        std::string type;
+        uint32_t size;
+        if (!(stream >> type >> size) || type[0] == '#')
+        {
+            return false;
+        }
+        switch (type[0])
+        {
+        case 'I':
+            frame.m_type = VideoStreamFrameHeader::FRAME_I;
+            break;
+        case 'P':
+            frame.m_type = VideoStreamFrameHeader::FRAME_P;
+            break;
+        case 'B':
+            frame.m_type = VideoStreamFrameHeader::FRAME_B;
+            break;
+        default:
+            return false;
+        }
+        frame.m_size = std::max<uint32_t>(size, 1);
+        frame.m_refDistance = 0;
+        return true;
+    }
+
+    std::vector<VideoFrameTrace::Frame>
+    VideoFrameTrace::ReadChunk(uint32_t chunk)
+    {
+        NS_LOG_FUNCTION(this << chunk);
+        uint32_t frames = std::min(m_chunkFrames, m_frameCount - chunk * m_chunkFrames);
+        std::vector<Frame> result;
+        result.reserve(frames);
+        m_file.clear();
+        m_file.seekg(m_chunkOffsets[chunk]);
+        std::string line;
+        Frame frame;
+        uint32_t lastRef = m_chunkRefs[chunk];
+        while (result.size() < frames && std::getline(m_file, line))
+        {
+            if (ParseLine(line, frame))
+            {
+                // P와 B 프레임은 가장 가까운 앞의 I 또는 P 프레임을 참조한다
+                uint32_t frameNum = chunk * m_chunkFrames + result.size();
+                if (frame.m_type != VideoStreamFrameHeader::FRAME_I && lastRef != NO_REF
+                    && frameNum - lastRef <= VideoStreamFrameHeader::MAX_REF_DISTANCE)
+                {
+                    frame.m_refDistance = frameNum - lastRef;
+                }
+                if (frame.m_type != VideoStreamFrameHeader::FRAME_B)
+                {
+                    lastRef = frameNum;
+                }
+                result.push_back(frame);
+            }
+        }
+        NS_ABORT_MSG_IF(result.size() != frames, "Video trace " << m_filename << " changed while it was read");
+        return result;
+    }
+
+} // namespace ns3
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_FRAME_TRACE_H
+#define VIDEO_FRAME_TRACE_H
+
+#include "ns3/video-stream-frame-header.h"
+
+#include <stdint.h>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * @brief Frame sizes and types read from an encoded video trace.
+     *
+     * Every line of the trace describes one frame in decoding order as
+     * `<type> <bytes>`, where type is I, P or B. Empty lines and lines
+     * starting with '#' are skipped.
+     *
+     * The file is scanned once on Open to count the frames and find the
+     * largest one, keeping only the file offset of every chunk of frames
+     * and the last I or P frame before it, so the reference distance of
+     * every frame is computed once as its chunk is read.
+     * Frames are then read back one chunk at a time into a small least
+     * recently used cache, so the memory used does not grow with the length
+     * of the trace.
+     */
+    class VideoFrameTrace
+    {
+    public:
+        /**
+         * @brief One frame of the trace.
+         */
+        struct Frame
+        {
+            uint32_t m_size;                          //!< Bytes of the encoded frame
+            VideoStreamFrameHeader::FrameType m_type; //!< Coding type of the frame
+            uint8_t m_refDistance;                    //!< Frames back to the closest earlier I or P frame, 0 for an I frame or none within MAX_REF_DISTANCE
+        };
+
+        VideoFrameTrace();
+
+        /**
+         * @brief Open a trace and index it.
+         *
+         * @param filename the trace file
+         * @param chunkFrames the number of frames read at once
+         * @param cacheChunks the number of chunks kept in memory
+         */
+        void Open(std::string filename, uint32_t chunkFrames = 1024, uint32_t cacheChunks = 4);
+
+        /**
+         * @brief Change the number of chunks kept in memory.
+         *
+         * The least recently used chunks are dropped if the cache shrinks.
+         *
+         * @param cacheChunks the number of chunks kept in memory
+         */
+        void SetCacheChunks(uint32_t cacheChunks);
+
+        /**
+         * @return true if a trace was opened
+         */
+        bool IsOpen(void) const;
+
+        /**
+         * @brief Close the file and drop the cache.
+         */
+        void Close(void);
+
+        /**
+         * @return the number of frames of the trace
+         */
+        uint32_t GetFrameCount(void) const;
+
+        /**
+         * @return the number of bytes of the largest frame
+         */
+        uint32_t GetMaxFrameSize(void) const;
+
+        /**
+         * @return the mean number of bytes of a frame
+         */
+        double GetMeanFrameSize(void) const;
+
+        /**
+         * @param frameNum the frame number, the trace is repeated past its end
+         * @return the frame
+         */
+        Frame GetFrame(uint32_t frameNum);
+
+    private:
+        static const uint32_t NO_REF = 0xffffffff; //!< No I or P frame yet
+
+        /**
+         * @brief Parse one line of the trace.
+         *
+         * @param line the line
+         * @param frame the frame the line describes
+         * @return false if the line does not describe a frame
+         */
+        static bool ParseLine(const std::string &line, Frame &frame);
+
+        /**
+         * @brief Read a chunk from the file.
+         *
+         * @param chunk the chunk number
+         * @return the frames of the chunk
+         */
+        std::vector<Frame> ReadChunk(uint32_t chunk);
+
+        typedef std::pair<std::vector<Frame>, std::list<uint32_t>::iterator> ChunkEntry;
+
+        std::string m_filename;
+        std::ifstream m_file;
+        uint32_t m_chunkFrames;
+        uint32_t m_cacheChunks;
+        uint32_t m_frameCount;
+        uint32_t m_maxFrameSize;
+        uint64_t m_totalBytes;
+        std::vector<std::streamoff> m_chunkOffsets; //!< File offset of the first line of every chunk
+        std::vector<uint32_t> m_chunkRefs;          //!< Last I or P frame before every chunk, NO_REF if none
+        std::list<uint32_t> m_lru;                  //!< Cached chunk numbers, most recently used first
+        std::unordered_map<uint32_t, ChunkEntry> m_chunks; //!< Chunk number -> frames
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_FRAME_TRACE_H */
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-stream-abr.h"
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamAbr");
+
+    VideoStreamAbr::VideoStreamAbr()
+        : m_algorithm(ABR_NONE),
+          m_reservoir(20),
+          m_cushion(60),
+          m_safety(0.8)
+    {
+    }
+
+    void
+    VideoStreamAbr::Setup(Algorithm algorithm, uint32_t reservoir, uint32_t cushion, double safety)
+    {
+        m_algorithm = algorithm;
+        m_reservoir = reservoir;
+        m_cushion = cushion;
+        m_safety = safety;
+    }
+
+    uint32_t
+    VideoStreamAbr::SelectLevel(uint32_t level, uint32_t bufferedFrames, uint64_t throughput, uint64_t topBitrate) const
+    {
+        NS_LOG_FUNCTION(this << level << bufferedFrames << throughput << topBitrate);
+
+        switch (m_algorithm)
+        {
+        case ABR_BUFFER:
+            if (bufferedFrames <= m_reservoir)
+            {
+                return 1;
+            }
+            if (bufferedFrames >= m_reservoir + m_cushion || m_cushion == 0)
+            {
+                return MAX_VIDEO_LEVEL;
+            }
+            return 1 + (MAX_VIDEO_LEVEL - 1) * (bufferedFrames - m_reservoir) / m_cushion;
+
+        case ABR_THROUGHPUT:
+        {
+            // 현재 레벨을 다 받아내고 있으면 한 단계 올려 본다
+            uint64_t currentBitrate = topBitrate * level / MAX_VIDEO_LEVEL;
+            if (throughput >= 0.95 * currentBitrate)
+            {
+                return level < MAX_VIDEO_LEVEL ? level + 1 : level;
+            }
+            // 그렇지 않으면 측정된 처리량으로 감당할 수 있는 가장 높은 레벨
+            uint32_t newLevel = MAX_VIDEO_LEVEL;
+            while (newLevel > 1 && topBitrate * newLevel / MAX_VIDEO_LEVEL > m_safety * throughput)
+            {
+                newLevel--;
+            }
+            return newLevel;
+        }
+
+        default:
+            return MAX_VIDEO_LEVEL;
+        }
+    }
+
+    VideoStreamAbr::Algorithm
+    VideoStreamAbr::GetAlgorithm(void) const
+    {
+        return m_algorithm;
+    }
+
+} // namespace ns3
@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_ABR_H
+#define VIDEO_STREAM_ABR_H
+
+#include <stdint.h>
+
+#define MAX_VIDEO_LEVEL 6
+
+namespace ns3
+{
+
+    /**
+     * @brief Adaptive bitrate logic of the video stream.
+     *
+     * Picks a video level in [1, MAX_VIDEO_LEVEL] for a client from the
+     * buffer occupancy and throughput it reports. The frame size of level l
+     * is l / MAX_VIDEO_LEVEL of the full frame size.
+     */
+    class VideoStreamAbr
+    {
+    public:
+        enum Algorithm
+        {
+            ABR_NONE,      //!< Always stream the highest level
+            ABR_BUFFER,    //!< Map the buffer occupancy linearly onto the levels
+            ABR_THROUGHPUT //!< Pick the highest level the measured throughput sustains
+        };
+
+        VideoStreamAbr();
+
+        /**
+         * @brief Configure the algorithm.
+         *
+         * @param algorithm the algorithm used to select levels
+         * @param reservoir buffered frames below which the lowest level is used
+         * @param cushion buffered frames above the reservoir at which the highest level is reached
+         * @param safety fraction of the measured throughput the video may use
+         */
+        void Setup(Algorithm algorithm, uint32_t reservoir, uint32_t cushion, double safety);
+
+        /**
+         * @brief Select the level of the next frames.
+         *
+         * @param level the current level
+         * @param bufferedFrames frames buffered at the client
+         * @param throughput throughput measured by the client in bit/s
+         * @param topBitrate bitrate of MAX_VIDEO_LEVEL in bit/s
+         * @return the new level
+         */
+        uint32_t SelectLevel(uint32_t level, uint32_t bufferedFrames, uint64_t throughput, uint64_t topBitrate) const;
+
+        /**
+         * @return the configured algorithm
+         */
+        Algorithm GetAlgorithm(void) const;
+
+    private:
+        Algorithm m_algorithm;
+        uint32_t m_reservoir;
+        uint32_t m_cushion;
+        double m_safety;
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_ABR_H */
@@ -11,11 +11,19 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
 #include "video-stream-client.h"
 
-// seqts header
-#include "seq-ts-header.h"
+#include "video-stream-nack-header.h"
+#include "video-stream-report-header.h"
+#include "video-stream-frame-header.h"
+#include "video-stream-info-header.h"
+#include "video-frame-reassembly.h"
+
+#include <algorithm>
 
 namespace ns3
 {
@@ -39,27 +47,183 @@ namespace ns3
                                               UintegerValue(5000),
                                               MakeUintegerAccessor(&VideoStreamClient::m_peerPort),
                                               MakeUintegerChecker<uint16_t>())
-                                .AddAttribute("PacketNum", "The number of packets per frame",
+                                .AddAttribute("PacketNum", "The number of packets of the largest frame, replaced by the one the server sends",
                                               UintegerValue(100),
                                               MakeUintegerAccessor(&VideoStreamClient::m_packetNum),
-                                              MakeUintegerChecker<uint32_t>());
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("InitialDelay", "The time from the start of the application before the first frame may be played",
+                                              TimeValue(Seconds(3)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_initialDelay),
+                                              MakeTimeChecker(Seconds(0)))
+                                .AddAttribute("FrameRate", "The number of frames played per second",
+                                              UintegerValue(20),
+                                              MakeUintegerAccessor(&VideoStreamClient::m_frameRate),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddAttribute("StartThreshold", "The buffered frames needed to start playing after the initial delay",
+                                              UintegerValue(1),
+                                              MakeUintegerAccessor(&VideoStreamClient::m_startThreshold),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddAttribute("StartThresholdTime", "The buffered playout time needed to start playing, "
+                                              "combined with StartThreshold by taking the larger number of frames",
+                                              TimeValue(Seconds(0)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_startThresholdTime),
+                                              MakeTimeChecker(Seconds(0)))
+                                .AddAttribute("ResumeThreshold", "The buffered frames needed to resume playing after a stall",
+                                              UintegerValue(1),
+                                              MakeUintegerAccessor(&VideoStreamClient::m_resumeThreshold),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddAttribute("ResumeThresholdTime", "The buffered playout time needed to resume playing after a stall, "
+                                              "combined with ResumeThreshold by taking the larger number of frames",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_resumeThresholdTime),
+                                              MakeTimeChecker(Seconds(0)))
+                                .AddAttribute("AdaptivePlayout", "Whether frames are played slower while the buffer is low and faster while it is high, "
+                                              "so short throughput dips are absorbed without stalls",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&VideoStreamClient::m_adaptivePlayout),
+                                              MakeBooleanChecker())
+                                .AddAttribute("PlayoutLowWatermark", "The buffered playout time below which frames are played at PlayoutSlowRate",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_playoutLowWatermark),
+                                              MakeTimeChecker(Seconds(0)))
+                                .AddAttribute("PlayoutHighWatermark", "The buffered playout time above which frames are played at PlayoutFastRate",
+                                              TimeValue(Seconds(3)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_playoutHighWatermark),
+                                              MakeTimeChecker(Seconds(0)))
+                                .AddAttribute("PlayoutSlowRate", "The playout rate relative to FrameRate below the low watermark",
+                                              DoubleValue(0.9),
+                                              MakeDoubleAccessor(&VideoStreamClient::m_playoutSlowRate),
+                                              MakeDoubleChecker<double>(0.1, 1.0))
+                                .AddAttribute("PlayoutFastRate", "The playout rate relative to FrameRate above the high watermark",
+                                              DoubleValue(1.1),
+                                              MakeDoubleAccessor(&VideoStreamClient::m_playoutFastRate),
+                                              MakeDoubleChecker<double>(1.0, 10.0))
+                                .AddAttribute("NackInterval", "The feedback interval in which missing packets are coalesced into one NACK",
+                                              TimeValue(MilliSeconds(1.0)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_nackInterval),
+                                              MakeTimeChecker())
+                                .AddAttribute("RetransTimeoutInitial", "The retransmission timeout of a NACK before the first round trip time sample",
+                                              TimeValue(MilliSeconds(100)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_rtoInitial),
+                                              MakeTimeChecker())
+                                .AddAttribute("RetransTimeoutMin", "The smallest retransmission timeout of a NACK",
+                                              TimeValue(MilliSeconds(10)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_rtoMin),
+                                              MakeTimeChecker())
+                                .AddAttribute("RetransTimeoutMax", "The largest retransmission timeout of a NACK, including the backoff",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_rtoMax),
+                                              MakeTimeChecker())
+                                .AddAttribute("MaxRetransRequests", "The number of NACKs sent for one lost packet before giving up",
+                                              UintegerValue(4),
+                                              MakeUintegerAccessor(&VideoStreamClient::m_maxRetransRequests),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddAttribute("ReportInterval", "The interval between two reports of buffer occupancy and throughput",
+                                              TimeValue(Seconds(0.5)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_reportInterval),
+                                              MakeTimeChecker())
+                                .AddAttribute("KeepaliveInterval", "The longest time without a packet to the server before a keepalive is sent",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&VideoStreamClient::m_keepaliveInterval),
+                                              MakeTimeChecker(MilliSeconds(1)))
+                                .AddAttribute("MulticastGroup", "The group the stream is received from, must match the server. "
+                                              "Any non-multicast address receives a unicast stream.",
+                                              Ipv4AddressValue(Ipv4Address::GetAny()),
+                                              MakeIpv4AddressAccessor(&VideoStreamClient::m_multicastGroup),
+                                              MakeIpv4AddressChecker())
+                                .AddAttribute("MulticastPort", "The port the group is received on, must match the server",
+                                              UintegerValue(5001),
+                                              MakeUintegerAccessor(&VideoStreamClient::m_multicastPort),
+                                              MakeUintegerChecker<uint16_t>())
+                                .AddAttribute("EnableNack", "Whether lost packets are requested again from the server",
+                                              BooleanValue(true),
+                                              MakeBooleanAccessor(&VideoStreamClient::m_enableNack),
+                                              MakeBooleanChecker())
+                                .AddAttribute("FecMode", "The forward error correction code of the stream, must match the server",
+                                              EnumValue(VideoStreamFec::FEC_NONE),
+                                              MakeEnumAccessor(&VideoStreamClient::m_fecMode),
+                                              MakeEnumChecker(VideoStreamFec::FEC_NONE, "None",
+                                                              VideoStreamFec::FEC_XOR, "Xor",
+                                                              VideoStreamFec::FEC_REED_SOLOMON, "ReedSolomon"))
+                                .AddAttribute("FecBlockSize", "Source packets protected by each group of parity packets, must match the server",
+                                              UintegerValue(0),
+                                              MakeUintegerAccessor(&VideoStreamClient::m_fecBlockSize),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("FecParity", "Parity packets per block with Reed-Solomon, must match the server",
+                                              UintegerValue(2),
+                                              MakeUintegerAccessor(&VideoStreamClient::m_fecParity),
+                                              MakeUintegerChecker<uint32_t>(1, 255))
+                                .AddTraceSource("FecRecovered", "Number of lost packets recovered from parity packets",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_fecRecovered),
+                                                "ns3::TracedValueCallback::Uint64")
+                                .AddTraceSource("Tx", "A hello, NACK, report, keepalive or bye packet is sent",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_txTrace),
+                                                "ns3::Packet::TracedCallback")
+                                .AddTraceSource("Rx", "A packet of the stream is received",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_rxTrace),
+                                                "ns3::Packet::AddressTracedCallback")
+                                .AddTraceSource("RetransmissionRequest", "A lost sequence number is requested in a NACK",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_retransRequestTrace),
+                                                "ns3::VideoStreamClient::SeqNumCallback")
+                                .AddTraceSource("RetransmissionReceived", "A sequence number arrives after its gap was detected",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_retransRecvTrace),
+                                                "ns3::VideoStreamClient::SeqNumCallback")
+                                .AddTraceSource("FrameComplete", "Every packet of a frame has arrived or been recovered",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_frameCompleteTrace),
+                                                "ns3::VideoStreamClient::FrameCallback")
+                                .AddTraceSource("FrameUndecodable", "A complete frame is played but cannot be decoded because its reference frame could not",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_undecodableTrace),
+                                                "ns3::VideoStreamClient::SeqNumCallback")
+                                .AddTraceSource("Playout", "A frame is played, counted as complete, partial or missing",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_playoutTrace),
+                                                "ns3::VideoStreamClient::PlayoutCallback")
+                                .AddTraceSource("FrameLatency", "A complete frame is played, with its send time, first arrival, completion and last arrival "
+                                                "that was not a retransmission",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_frameLatencyTrace),
+                                                "ns3::VideoStreamClient::FrameLatencyCallback")
+                                .AddTraceSource("PlayoutState", "The playout changed between buffering, playing, stalled and ended",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_playoutState),
+                                                "ns3::VideoStreamClient::PlayoutStateCallback")
+                                .AddTraceSource("PlayoutRate", "The playout rate relative to FrameRate changed",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_playoutRate),
+                                                "ns3::TracedValueCallback::Double")
+                                .AddTraceSource("StallStart", "The buffer ran out of frames during playout",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_stallStartTrace),
+                                                "ns3::VideoStreamClient::StallStartCallback")
+                                .AddTraceSource("StallEnd", "Playout resumed after a stall",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_stallEndTrace),
+                                                "ns3::Time::TracedCallback")
+                                .AddTraceSource("Rtt", "A round trip time sample from a NACK to the first arrival of the packet it requested",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_rttTrace),
+                                                "ns3::VideoStreamClient::RttCallback")
+                                .AddTraceSource("Jitter", "Interarrival jitter of the stream (RFC 3550)",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_jitter),
+                                                "ns3::TracedValueCallback::Time")
+                                .AddTraceSource("BufferLevel", "Number of received frames waiting to be played",
+                                                MakeTraceSourceAccessor(&VideoStreamClient::m_frameBufferSize),
+                                                "ns3::TracedValueCallback::Uint32");
         return tid;
     }
 
     VideoStreamClient::VideoStreamClient()
     {
         NS_LOG_FUNCTION(this);
-        m_initialDelay = 3;
         m_currentBufferSize = 0;
-        m_frameSize = 0;
-        m_frameRate = 20;
         m_lastRecvFrame = 0;
         m_bufferEvent = EventId();
         m_sendEvent = EventId();
         m_expectedSeq = 0;
-        m_retransPktSize = 100;
-        m_frameFront = 0;
         m_frameBufferSize = 0;
+        m_playoutState = PLAYOUT_BUFFERING;
+        m_playoutRate = 1.0;
+        m_reportBytes = 0;
+        m_reportLost = 0;
+        m_reportReceived = 0;
+        m_fecRecovered = 0;
+        m_joined = false;
+        m_infoReceived = false;
+        m_totalFrames = 0;
+        m_jitter = Time();
     }
 
     VideoStreamClient::~VideoStreamClient()
@@ -136,9 +300,33 @@ namespace ns3
                 NS_ASSERT_MSG(false, "Incompatible address type: " << m_peerAddress);
             }
         }
+        m_fec.Setup(m_fecMode, m_packetNum, m_fecBlockSize, m_fecParity);
+        m_reassembly.Setup(m_packetNum, REASSEMBLY_WINDOW, m_fec);
+        m_frameRefs.assign(REASSEMBLY_WINDOW, -1);
+        FrameTiming unused;
+        unused.m_frameNum = 0xffffffff;
+        m_frameTimings.assign(TIMING_HISTORY, unused);
+        m_decoded.assign(DECODE_HISTORY, false);
+        m_rtt.Setup(m_rtoInitial, m_rtoMin, m_rtoMax, m_nackInterval);
+        m_retransTimers.Setup(m_nackInterval, TIMER_WHEEL_SLOTS, MakeCallback(&VideoStreamClient::HandleRetransTimeout, this));
         m_socket->SetRecvCallback(MakeCallback(&VideoStreamClient::HandleRead, this));
+        if (m_multicastGroup.IsMulticast() && m_groupSocket == 0)
+        {
+            // 그룹 스트림은 별도 소켓으로 받고, 유니캐스트 재전송은 기존 소켓으로 받는다
+            m_groupSocket = Socket::CreateSocket(GetNode(), TypeId::LookupByName("ns3::UdpSocketFactory"));
+            if (m_groupSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_multicastPort)) == -1)
+            {
+                NS_FATAL_ERROR("Failed to bind multicast socket");
+            }
+            m_groupSocket->SetRecvCallback(MakeCallback(&VideoStreamClient::HandleRead, this));
+        }
         m_sendEvent = Simulator::Schedule(MilliSeconds(1.0), &VideoStreamClient::Send, this);
-        m_bufferEvent = Simulator::Schedule(Seconds(m_initialDelay), &VideoStreamClient::ReadFromBuffer, this);
+        m_frameInterval = Seconds(1.0 / m_frameRate);
+        m_playoutStart = Simulator::Now() + m_initialDelay;
+        m_bufferEvent = Simulator::Schedule(m_initialDelay, &VideoStreamClient::CheckPlayoutStart, this);
+        m_lastReport = Simulator::Now();
+        m_reportEvent = Simulator::Schedule(m_reportInterval, &VideoStreamClient::SendReport, this);
+        m_keepaliveEvent = Simulator::Schedule(m_keepaliveInterval, &VideoStreamClient::SendKeepalive, this);
     }
 
     void
@@ -148,12 +336,26 @@ namespace ns3
 
         if (m_socket != 0)
         {
+            // 서버가 타임아웃을 기다리지 않고 바로 스트림을 멈추고 상태를 지우게 한다
+            SendControl(Create<Packet>(), VideoStreamControlHeader::BYE);
             m_socket->Close();
             m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
             m_socket = 0;
         }
+        if (m_groupSocket != 0)
+        {
+            m_groupSocket->Close();
+            m_groupSocket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+            m_groupSocket = 0;
+        }
 
         Simulator::Cancel(m_bufferEvent);
+        Simulator::Cancel(m_retransEvent);
+        Simulator::Cancel(m_reportEvent);
+        Simulator::Cancel(m_keepaliveEvent);
+        m_retransTimers.Clear();
+        m_requests.clear();
+        m_pendingPackets.clear();
     }
 
     void
@@ -163,8 +365,7 @@ namespace ns3
         NS_ASSERT(m_sendEvent.IsExpired());
 
         // Server와 Connection을 위해 사용
-        Ptr<Packet> firstPacket = Create<Packet>(10);
-        m_socket->Send(firstPacket);
+        SendControl(Create<Packet>(), VideoStreamControlHeader::HELLO);
 
         if (Ipv4Address::IsMatchingType(m_peerAddress))
         {
@@ -187,65 +388,386 @@ namespace ns3
     void
     VideoStreamClient::SendRetransRequest(void)
     {
+        // 한 피드백 주기 동안 쌓인 seq 번호들을 하나의 NACK으로 묶는다
+        VideoStreamNackHeader nack;
+        while (!m_retransBuffer.empty())
+        {
+            uint32_t seqNum = m_retransBuffer.top();
+            uint32_t frameNum = seqNum / m_packetNum;
+            // 이미 재생된 프레임이나 그 사이 FEC로 복구된 패킷, 프레임 크기를 알고 보니 없는 패킷은 요청하지 않는다
+            // 응답을 기다리는 중인 seq도 타임아웃 전에는 다시 요청하지 않는다
+            if (!m_reassembly.IsPending(frameNum) || m_reassembly.HasPacket(frameNum, seqNum % m_packetNum) || !IsExpectedSeqNum(seqNum) ||
+                m_retransTimers.IsPending(seqNum))
+            {
+                m_retransBuffer.pop();
+                continue;
+            }
+            if (m_fec.IsEnabled())
+            {
+                // 블록 다음 패킷이 도착하기 전이면 패리티로 복구될 수 있으므로 기다린다
+                uint32_t framePackets = m_reassembly.GetFramePackets(frameNum);
+                if (framePackets == 0)
+                {
+                    framePackets = m_packetNum;
+                }
+                uint32_t block = m_fec.GetBlock(seqNum % m_packetNum, framePackets);
+                uint32_t blockEnd = frameNum * m_packetNum + m_fec.GetBlockStart(block, framePackets) + m_fec.GetBlockLength(block, framePackets);
+                if (m_expectedSeq <= blockEnd)
+                {
+                    break;
+                }
+            }
+            if (!nack.AddSeqNum(seqNum))
+            {
+                break;
+            }
+            m_retransRequestTrace(seqNum);
+            m_retransBuffer.pop();
+
+            // 요청할 때마다 타임아웃을 두 배로 늘린다
+            RetransRequest &request = m_requests[seqNum];
+            request.m_sent = Simulator::Now();
+            request.m_attempts++;
+            Time timeout = m_rtt.GetRto() * static_cast<int64_t>(1u << std::min<uint32_t>(request.m_attempts - 1, 16));
+            m_retransTimers.Schedule(seqNum, std::min(timeout, m_rtoMax));
+        }
+        if (!nack.IsEmpty())
+        {
+            nack.SetDeadline(GetFrameDeadline(nack.GetBaseSeqNum() / m_packetNum), GetPlayoutInterval());
+            // NS_LOG_INFO("[Client] At time " << Simulator::Now().GetSeconds() << " retrans request " << nack);
+            Ptr<Packet> retransRequestPacket = Create<Packet>();
+            retransRequestPacket->AddHeader(nack);
+            SendControl(retransRequestPacket, VideoStreamControlHeader::NACK);
+        }
+        // 한 NACK에 담지 못했거나 아직 요청하지 않은 seq가 남아 있으면 다음 주기에 이어서 요청
         if (!m_retransBuffer.empty())
+            m_retransEvent = Simulator::Schedule(m_nackInterval, &VideoStreamClient::SendRetransRequest, this);
+    }
+
+    void
+    VideoStreamClient::SendControl(Ptr<Packet> packet, VideoStreamControlHeader::MessageType type)
+    {
+        VideoStreamControlHeader control(type);
+        packet->AddHeader(control);
+        m_txTrace(packet);
+        m_socket->Send(packet);
+        m_lastTx = Simulator::Now();
+    }
+
+    void
+    VideoStreamClient::SendKeepalive(void)
+    {
+        NS_LOG_FUNCTION(this);
+        // 스트림 정보를 받지 못했으면 HELLO로 다시 요청한다
+        if (!m_infoReceived)
         {
-            // 패킷 생성
-            Ptr<Packet> retransRequestPacket = Create<Packet>(m_retransPktSize);
+            SendControl(Create<Packet>(), VideoStreamControlHeader::HELLO);
+        }
+        // 마지막 패킷 이후 KeepaliveInterval 동안 보낸 것이 없을 때만 보낸다
+        else if (Simulator::Now() - m_lastTx >= m_keepaliveInterval)
+        {
+            SendControl(Create<Packet>(), VideoStreamControlHeader::KEEPALIVE);
+        }
+        m_keepaliveEvent = Simulator::Schedule(m_lastTx + m_keepaliveInterval - Simulator::Now(), &VideoStreamClient::SendKeepalive, this);
+    }
 
-            // seqTsHeader 생성
-            SeqTsHeader seqTs;
-            uint32_t retransSeq = m_retransBuffer.front();
-            m_retransBuffer.pop();
-            seqTs.SetSeq(retransSeq);
-            // NS_LOG_INFO("[Client] At time " << Simulator::Now().GetSeconds() << " retrans request for pkt # " << retransSeq);
-            // 패킷에 seq header 붙이기 + 전송
-            retransRequestPacket->AddHeader(seqTs);
-            m_socket->Send(retransRequestPacket);
-            // retransBuffer가 비어있지 않는 경우 retrans 다시 진행
-            if (!m_retransBuffer.empty())
-                m_retransEvent = Simulator::Schedule(MilliSeconds(1.0), &VideoStreamClient::SendRetransRequest, this);
+    void
+    VideoStreamClient::HandleRetransTimeout(uint32_t seqNum)
+    {
+        NS_LOG_FUNCTION(this << seqNum);
+        std::unordered_map<uint32_t, RetransRequest>::iterator it = m_requests.find(seqNum);
+        if (it == m_requests.end())
+        {
+            return;
+        }
+        uint32_t frameNum = seqNum / m_packetNum;
+        // 재생된 프레임이거나 그 사이 받은 패킷, 요청 횟수를 다 쓴 패킷은 포기한다
+        if (!m_reassembly.IsPending(frameNum) || m_reassembly.HasPacket(frameNum, seqNum % m_packetNum) ||
+            it->second.m_attempts >= m_maxRetransRequests)
+        {
+            m_requests.erase(it);
+            return;
         }
+        m_retransBuffer.push(seqNum);
+        if (!m_retransEvent.IsRunning())
+            m_retransEvent = Simulator::Schedule(m_nackInterval, &VideoStreamClient::SendRetransRequest, this);
     }
 
-    uint32_t
+    bool
+    VideoStreamClient::IsExpectedSeqNum(uint32_t seqNum) const
+    {
+        // 패킷을 하나도 받지 못한 프레임은 크기를 모르므로 예약된 seq 전부를 요청한다
+        uint32_t framePackets = m_reassembly.GetFramePackets(seqNum / m_packetNum);
+        return framePackets == 0 || seqNum % m_packetNum < framePackets;
+    }
+
+    Time
+    VideoStreamClient::GetFrameDeadline(uint32_t frameNum) const
+    {
+        // 재생 중이면 다음 프레임 재생 시각부터, 아니면 재생이 가장 빨리 시작될 시각부터 한 프레임씩 센다
+        Time next = Time();
+        if (m_playoutState == PLAYOUT_PLAYING)
+        {
+            next = Simulator::GetDelayLeft(m_bufferEvent);
+        }
+        else if (m_playoutStart > Simulator::Now())
+        {
+            next = m_playoutStart - Simulator::Now();
+        }
+        return next + GetPlayoutInterval() * static_cast<int64_t>(frameNum - m_reassembly.GetPlayoutFrame());
+    }
+
+    void
+    VideoStreamClient::SendReport(void)
+    {
+        NS_LOG_FUNCTION(this);
+
+        VideoStreamReportHeader report;
+        report.SetBufferedFrames(std::min<uint32_t>(m_frameBufferSize.Get(), 0xffff));
+        Time elapsed = Simulator::Now() - m_lastReport;
+        report.SetThroughput(elapsed.IsStrictlyPositive() ? m_reportBytes * 8 / elapsed.GetSeconds() : 0);
+        uint32_t expected = m_reportReceived + m_reportLost;
+        report.SetLossFraction(expected > 0 ? std::min(1.0, static_cast<double>(m_reportLost) / expected) : 0.0);
+        if (m_lastRecvTime.IsStrictlyPositive())
+        {
+            // 패킷을 들고 있던 시간만큼 타임스탬프를 늦춰 서버가 바로 RTT를 구하게 한다
+            report.SetEchoTimestamp(m_lastSendTs + (Simulator::Now() - m_lastRecvTime));
+        }
+        m_reportBytes = 0;
+        m_reportLost = 0;
+        m_reportReceived = 0;
+        m_lastReport = Simulator::Now();
+
+        Ptr<Packet> reportPacket = Create<Packet>();
+        reportPacket->AddHeader(report);
+        SendControl(reportPacket, VideoStreamControlHeader::REPORT);
+
+        m_reportEvent = Simulator::Schedule(m_reportInterval, &VideoStreamClient::SendReport, this);
+    }
+
+    void
     VideoStreamClient::ReadFromBuffer(void)
     {
-        uint32_t count = 0; // 소비했던 프레임 개수
-        if (m_frameBufferSize < m_frameRate)
+        NS_LOG_FUNCTION(this);
+        // 재생할 프레임이 없으면 이 프레임 시각에 끊김이 시작된다
+        if (m_frameBufferSize.Get() == 0)
         {
-            // 남아있는 프레임 만큼만 소비하기
-            count = 0;
-            for (uint32_t i = m_frameFront; i < m_frameFront + m_frameBufferSize; i++)
-            {
-                if (m_frameBuffer[i] > 0)
-                {
-                    count += 1;
-                    m_frameBuffer[i] = 0; // i번재 프레임 소비
-                }
-            }
-            m_frameFront = m_frameFront + m_frameBufferSize;             // 사용가능한 프레임의 포인터인덱스 값 조정
-            m_frameBufferSize -= m_frameBufferSize;                      // 소비된 만큼 프레임 버퍼에 저장된 사이즈 줄이기
-            NS_LOG_INFO(Simulator::Now().GetSeconds() << "\t" << count); // 사용한 프레임 개수 출력
-            m_bufferEvent = Simulator::Schedule(Seconds(1.0), &VideoStreamClient::ReadFromBuffer, this);
-            return (-1); // not consume frame
+            m_playoutState = PLAYOUT_STALLED;
+            m_playoutRate = 1.0;
+            m_stallStart = Simulator::Now();
+            NS_LOG_INFO(Simulator::Now().GetSeconds() << "\tstall at frame " << m_reassembly.GetPlayoutFrame());
+            m_stallStartTrace();
+            return;
         }
-        else // consume frame
+
+        uint32_t frameNum = m_reassembly.GetPlayoutFrame();
+        VideoFrameReassembly::FrameState state = m_reassembly.PopFrame();
+        DecodeFrame(frameNum, state);
+        const FrameTiming &timing = m_frameTimings[frameNum % TIMING_HISTORY];
+        if (state == VideoFrameReassembly::FRAME_COMPLETE && timing.m_frameNum == frameNum && timing.m_complete != Time::Max())
+        {
+            m_frameLatencyTrace(frameNum, timing.m_sent, timing.m_firstRx, timing.m_complete, timing.m_lastOriginalRx);
+        }
+        UpdateBufferLevel();
+        UpdatePlayoutRate();
+        NS_LOG_LOGIC(Simulator::Now().GetSeconds() << "\t" << frameNum << "\t" << state << "\t" << m_playoutRate.Get());
+        m_playoutTrace(state == VideoFrameReassembly::FRAME_COMPLETE, state == VideoFrameReassembly::FRAME_PARTIAL,
+                       state == VideoFrameReassembly::FRAME_MISSING);
+        // 스트림의 마지막 프레임을 재생했으면 더 기다리지 않는다
+        if (m_totalFrames > 0 && frameNum + 1 >= m_totalFrames)
+        {
+            m_playoutState = PLAYOUT_ENDED;
+            m_playoutRate = 1.0;
+            NS_LOG_INFO(Simulator::Now().GetSeconds() << "\tend at frame " << frameNum);
+            return;
+        }
+        m_bufferEvent = Simulator::Schedule(GetPlayoutInterval(), &VideoStreamClient::ReadFromBuffer, this);
+    }
+
+    void
+    VideoStreamClient::UpdateBufferLevel(void)
+    {
+        // 뒤 프레임이 시작된 프레임들에 더해, 가장 최근 프레임은 완성되었거나 스트림의 마지막 프레임이면 센다
+        uint32_t playoutFrame = m_reassembly.GetPlayoutFrame();
+        uint32_t end = m_lastRecvFrame;
+        VideoFrameReassembly::FrameState state = m_reassembly.GetFrameState(end);
+        bool last = m_totalFrames > 0 && end + 1 >= m_totalFrames;
+        if (state == VideoFrameReassembly::FRAME_COMPLETE || (last && state == VideoFrameReassembly::FRAME_PARTIAL))
+        {
+            end++;
+        }
+        m_frameBufferSize = end > playoutFrame ? end - playoutFrame : 0;
+    }
+
+    void
+    VideoStreamClient::RecordFrameProgress(uint32_t frameNum)
+    {
+        if (frameNum < m_lastRecvFrame)
+        {
+            return;
+        }
+        m_lastRecvFrame = frameNum;
+        UpdateBufferLevel();
+        if (m_playoutState != PLAYOUT_PLAYING)
+        {
+            CheckPlayoutStart();
+        }
+    }
+
+    void
+    VideoStreamClient::UpdatePlayoutRate(void)
+    {
+        if (!m_adaptivePlayout)
+        {
+            return;
+        }
+        // 버퍼가 낮으면 천천히 재생해 도착을 기다리고, 높으면 빨리 재생해 지연을 줄인다
+        uint32_t buffered = m_frameBufferSize.Get();
+        double rate = 1.0;
+        if (buffered < GetThresholdFrames(0, m_playoutLowWatermark))
+        {
+            rate = m_playoutSlowRate;
+        }
+        else if (buffered > GetThresholdFrames(0, m_playoutHighWatermark))
+        {
+            rate = m_playoutFastRate;
+        }
+        m_playoutRate = rate;
+    }
+
+    Time
+    VideoStreamClient::GetPlayoutInterval(void) const
+    {
+        if (m_playoutRate.Get() == 1.0)
         {
-            // m_frameRate만큼만 소비하기
-            count = 0;
-            for (uint32_t i = m_frameFront; i < m_frameFront + m_frameRate; i++)
+            return m_frameInterval;
+        }
+        return Seconds(m_frameInterval.GetSeconds() / m_playoutRate.Get());
+    }
+
+    void
+    VideoStreamClient::CheckPlayoutStart(void)
+    {
+        if (m_playoutState == PLAYOUT_PLAYING || m_playoutState == PLAYOUT_ENDED || Simulator::Now() < m_playoutStart)
+        {
+            return;
+        }
+        uint32_t threshold = m_playoutState == PLAYOUT_BUFFERING ? GetThresholdFrames(m_startThreshold, m_startThresholdTime)
+                                                                 : GetThresholdFrames(m_resumeThreshold, m_resumeThresholdTime);
+        if (m_frameBufferSize.Get() < threshold)
+        {
+            return;
+        }
+        bool primed = m_playoutState == PLAYOUT_BUFFERING;
+        if (m_playoutState == PLAYOUT_STALLED)
+        {
+            m_stallEndTrace(Simulator::Now() - m_stallStart);
+        }
+        m_playoutState = PLAYOUT_PLAYING;
+        if (primed)
+        {
+            // 버퍼가 처음 찼음을 바로 알려 서버가 빠른 시작을 끝내게 한다
+            Simulator::Cancel(m_reportEvent);
+            SendReport();
+        }
+        // 임계값에 도달한 순간 첫 프레임을 재생한다
+        Simulator::Cancel(m_bufferEvent);
+        ReadFromBuffer();
+    }
+
+    uint32_t
+    VideoStreamClient::GetThresholdFrames(uint32_t frames, Time time) const
+    {
+        // 재생 시간으로 준 임계값은 프레임 개수로 올림한다
+        uint64_t timeFrames = (static_cast<uint64_t>(time.GetNanoSeconds()) * m_frameRate + 999999999) / 1000000000;
+        return std::max<uint64_t>(frames, timeFrames);
+    }
+
+    void
+    VideoStreamClient::RecordArrival(uint32_t frameNum, Time sent, bool retransmission)
+    {
+        // 순환 배열이므로 다른 프레임의 항목이면 새로 시작한다
+        FrameTiming &timing = m_frameTimings[frameNum % TIMING_HISTORY];
+        Time now = Simulator::Now();
+        if (timing.m_frameNum != frameNum)
+        {
+            timing.m_frameNum = frameNum;
+            timing.m_sent = sent;
+            timing.m_firstRx = now;
+            timing.m_lastOriginalRx = now;
+            timing.m_complete = Time::Max();
+        }
+        // 재전송 패킷의 타임스탬프는 재전송 시각이므로 가장 이른 타임스탬프를 프레임의 전송 시각으로 쓴다
+        timing.m_sent = std::min(timing.m_sent, sent);
+        if (!retransmission && timing.m_complete == Time::Max())
+        {
+            timing.m_lastOriginalRx = now;
+        }
+    }
+
+    void
+    VideoStreamClient::RecordComplete(uint32_t frameNum)
+    {
+        FrameTiming &timing = m_frameTimings[frameNum % TIMING_HISTORY];
+        if (timing.m_frameNum == frameNum && timing.m_complete == Time::Max())
+        {
+            timing.m_complete = Simulator::Now();
+        }
+    }
+
+    void
+    VideoStreamClient::DecodeFrame(uint32_t frameNum, VideoFrameReassembly::FrameState state)
+    {
+        int16_t ref = m_frameRefs[frameNum % REASSEMBLY_WINDOW];
+        m_frameRefs[frameNum % REASSEMBLY_WINDOW] = -1;
+        bool decodable = false;
+        if (state == VideoFrameReassembly::FRAME_COMPLETE)
+        {
+            // 참조 프레임이 디코딩되지 않았으면 완성된 프레임도 디코딩할 수 없다
+            decodable = ref == 0 || (ref > 0 && static_cast<uint32_t>(ref) <= frameNum && m_decoded[(frameNum - ref) % DECODE_HISTORY]);
+            if (!decodable)
             {
-                if (m_frameBuffer[i] > 0)
-                {
-                    count += 1;
-                    m_frameBuffer[i] = 0; // i번재 프레임 소비
-                }
+                m_undecodableTrace(frameNum);
             }
-            m_frameFront = m_frameFront + m_frameRate;                   // 사용가능한 프레임의 포인터인덱스 값 조정
-            m_frameBufferSize -= m_frameRate;                            // 소비된 만큼 프레임 버퍼에 저장된 사이즈 줄이기
-            NS_LOG_INFO(Simulator::Now().GetSeconds() << "\t" << count); // 사용한 프레임 개수 출력
-            m_bufferEvent = Simulator::Schedule(Seconds(1.0), &VideoStreamClient::ReadFromBuffer, this);
-            return (m_frameBufferSize);
+        }
+        m_decoded[frameNum % DECODE_HISTORY] = decodable;
+    }
+
+    void
+    VideoStreamClient::HandleStreamInfo(Ptr<Packet> packet)
+    {
+        VideoStreamInfoHeader info;
+        if (packet->GetSize() < info.GetSerializedSize())
+        {
+            NS_LOG_WARN("Dropped a stream info of " << packet->GetSize() << " bytes");
+            return;
+        }
+        packet->RemoveHeader(info);
+        // 다시 보낸 HELLO마다 오므로 처음 받은 것만 쓴다
+        if (m_infoReceived || info.GetStride() == 0)
+        {
+            return;
+        }
+        m_infoReceived = true;
+        m_packetNum = info.GetStride();
+        m_totalFrames = info.GetFrameCount();
+        m_fec.Setup(m_fecMode, m_packetNum, m_fecBlockSize, m_fecParity);
+        m_reassembly.Setup(m_packetNum, REASSEMBLY_WINDOW, m_fec);
+        m_expectedSeq = 0;
+        m_lastRecvFrame = 0;
+        // 유니캐스트는 서버가 0번 프레임부터 보내므로 앞 프레임이 손실되어도 0번부터 기다린다
+        m_joined = m_groupSocket == 0;
+        HandlePendingPackets();
+    }
+
+    void
+    VideoStreamClient::HandlePendingPackets(void)
+    {
+        std::vector<std::pair<Ptr<Packet>, bool>> pending;
+        pending.swap(m_pendingPackets);
+        for (uint32_t i = 0; i < pending.size(); i++)
+        {
+            HandlePacket(pending[i].first, pending[i].second);
         }
     }
 
@@ -255,70 +777,157 @@ namespace ns3
 
         Ptr<Packet> packet;
         Address from;
-        Address localAddress;
         while ((packet = socket->RecvFrom(from)))
         {
-            socket->GetSockName(localAddress);
+            m_rxTrace(packet, from);
             if (InetSocketAddress::IsMatchingType(from))
             {
-                uint32_t seqNum;   // 패킷 내 몇번째 패킷인지 담는 변수(seq)
-                uint32_t frameNum; // 현재 받고 있는 패킷이 속한 프레임의 번호 (seq 번호로 부터 추출)
-                uint32_t pktSize = packet->GetSize();
-                SeqTsHeader seqTs;
-                packet->RemoveHeader(seqTs);
-                seqNum = seqTs.GetSeq();
-                frameNum = seqNum / m_packetNum;
-
-                // 재전송으로 들어온 패킷이 아닌 경우
-                if (m_expectedSeq <= seqNum)
+                HandlePacket(packet, socket == m_groupSocket);
+            }
+        }
+    }
+
+    void
+    VideoStreamClient::HandlePacket(Ptr<Packet> packet, bool fromGroup)
+    {
+        uint32_t pktSize = packet->GetSize();
+        VideoStreamFrameHeader frameHeader;
+        if (pktSize < frameHeader.GetSerializedSize())
+        {
+            NS_LOG_WARN("Dropped a packet of " << pktSize << " bytes, shorter than the frame header");
+            return;
+        }
+        packet->RemoveHeader(frameHeader);
+        if (frameHeader.IsInfo())
+        {
+            HandleStreamInfo(packet);
+            return;
+        }
+        // 스트림 정보 전에는 프레임당 seq 개수를, 그룹 스트림의 첫 데이터 패킷 전에는 재생 시작 프레임을 모르므로 미뤄둔다
+        if (!m_joined && !(m_infoReceived && fromGroup && !frameHeader.IsParity()))
+        {
+            if (m_pendingPackets.size() < MAX_PENDING_PACKETS)
+            {
+                packet->AddHeader(frameHeader);
+                m_pendingPackets.push_back(std::make_pair(packet, fromGroup));
+            }
+            return;
+        }
+        m_reportBytes += pktSize;
+        uint32_t frameNum = frameHeader.GetFrameNum(); // 현재 받고 있는 패킷이 속한 프레임의 번호
+        uint32_t index = frameHeader.GetPacketIndex(); // 프레임 (패리티면 패리티 패킷들) 내 몇번째 패킷인지
+        Time sendTs = frameHeader.GetTimestamp(Simulator::Now());
+        m_lastSendTs = sendTs;
+        m_lastRecvTime = Simulator::Now();
+        uint32_t framePackets = frameHeader.GetFramePackets();
+
+        if (frameHeader.IsParity())
+        {
+            // 패리티 패킷은 데이터 seq 공간 밖이므로 손실 감지에 쓰지 않는다
+            if (m_reassembly.IsPending(frameNum))
+            {
+                m_frameRefs[frameNum % REASSEMBLY_WINDOW] = frameHeader.GetRefDistance();
+                RecordArrival(frameNum, sendTs, false);
+            }
+            bool wasComplete = m_reassembly.GetFrameState(frameNum) == VideoFrameReassembly::FRAME_COMPLETE;
+            m_reassembly.AddParity(frameNum, index, framePackets, pktSize);
+            m_fecRecovered = m_reassembly.GetRecovered();
+            if (!wasComplete && m_reassembly.GetFrameState(frameNum) == VideoFrameReassembly::FRAME_COMPLETE)
+            {
+                RecordComplete(frameNum);
+                m_frameCompleteTrace(frameNum, m_reassembly.GetFrameBytes(frameNum));
+                RecordFrameProgress(frameNum);
+            }
+            return;
+        }
+
+        if (!m_joined)
+        {
+            // 진행 중인 그룹 스트림에 들어왔으므로 첫 그룹 데이터 패킷의 프레임부터 재생한다
+            m_joined = true;
+            m_reassembly.Setup(m_packetNum, REASSEMBLY_WINDOW, m_fec, frameNum);
+            m_expectedSeq = frameNum * m_packetNum;
+            m_lastRecvFrame = frameNum;
+            HandlePendingPackets();
+        }
+        // NACK과 손실 감지는 프레임마다 m_packetNum개씩 예약된 seq 공간을 쓴다
+        uint32_t seqNum = frameNum * m_packetNum + index;
+        if (m_reassembly.IsPending(frameNum))
+        {
+            m_frameRefs[frameNum % REASSEMBLY_WINDOW] = frameHeader.GetRefDistance();
+        }
+
+        bool refill = seqNum < m_expectedSeq; // 이미 손실로 감지된 자리를 채우는 패킷
+        if (!refill)
+        {
+            m_reportReceived++;
+            // 재전송 패킷은 서버 큐에서 기다린 시간이 섞이므로 새 패킷으로만 지터를 구한다
+            Time transit = Simulator::Now() - sendTs;
+            if (!m_lastTransit.IsZero())
+            {
+                Time d = transit > m_lastTransit ? transit - m_lastTransit : m_lastTransit - transit;
+                m_jitter = m_jitter.Get() + (d - m_jitter.Get()) / 16;
+            }
+            m_lastTransit = transit;
+        }
+
+        // seq가 불연속 인 경우(일부 손실된 경우) => 재전송 요청 보내주기
+        if (seqNum > m_expectedSeq)
+        {
+            // t = [m_expectedSeq ~ seqNum - 1]번 중 프레임 크기를 넘지 않는 seq만 손실로 센다
+            for (uint32_t i = m_expectedSeq; i < seqNum; i++)
+            {
+                if (!IsExpectedSeqNum(i))
                 {
-                    // seq가 연속인 경우
-                    if (m_expectedSeq == seqNum)
-                    {
-                        m_expectedSeq++;
-                    }
-                    // seq가 불연속 인 경우(일부 손실된 경우) => 재전송 요청 보내주기
-                    else
-                    {
-                        if (seqNum > m_expectedSeq)
-                        {
-                            // t = [m_expectedSeq ~ seqNum - 1]번까지 재전송 요청
-                            // m_retransBuffer에 t들을 넣는다
-                            for (uint32_t i = m_expectedSeq; i < seqNum; i++)
-                                m_retransBuffer.push(i);
-                            // m_retransEvent에 SendRetrans(void) 이벤트를 트리거
-                            m_retransEvent = Simulator::Schedule(MilliSeconds(1.0), &VideoStreamClient::SendRetransRequest, this);
-                        }
-                        // m_expectedSeq 변경 후 m_frameSize 변경
-                        m_expectedSeq = seqNum + 1;
-                    }
-                    // frame번호에 따라 packet 사이즈 갱신
-                    if (frameNum == m_lastRecvFrame)
-                    {
-                        // 이전에 받은 패킷의 프레임 번호와 동일한 프레임 번호의 패킷인 경우 => 받은 frame의 크기를 증가 시킨다.
-                        m_frameSize += pktSize;
-                    }
-                    else
-                    {
-                        // 새로운 프레임 번호
-                        // NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << " new frame is saved : " << m_lastRecvFrame);
-                        m_frameBuffer[m_lastRecvFrame] = m_frameSize; // 누적된 프레임 등록
-                        m_frameBufferSize++;                          // frmaeBuffer에 저장된 프레임개수 증가
-                        m_lastRecvFrame = frameNum;                   // frame번호 갱신
-                        m_frameSize = pktSize;                        // m_frameSize 갱신
-                    }
+                    continue;
                 }
-                // 재전송으로 들어온 패킷인 경우
-                else
+                m_reportLost++;
+                // 아직 재생되지 않은 프레임의 패킷만 재전송 요청
+                if (m_enableNack && m_reassembly.IsPending(i / m_packetNum))
+                    m_retransBuffer.push(i);
+            }
+            // 예약된 NACK이 없을 때만 SendRetransRequest(void) 이벤트를 트리거 (피드백 주기당 한 번)
+            if (!m_retransBuffer.empty() && !m_retransEvent.IsRunning())
+                m_retransEvent = Simulator::Schedule(m_nackInterval, &VideoStreamClient::SendRetransRequest, this);
+        }
+        if (seqNum >= m_expectedSeq)
+        {
+            m_expectedSeq = seqNum + 1;
+        }
+
+        // 중복 패킷이나 이미 재생된 프레임의 패킷은 버린다
+        if (!m_reassembly.AddPacket(frameNum, index, framePackets, pktSize))
+        {
+            return;
+        }
+        m_fecRecovered = m_reassembly.GetRecovered();
+        RecordArrival(frameNum, sendTs, refill);
+        if (refill)
+        {
+            m_retransRecvTrace(seqNum);
+            std::unordered_map<uint32_t, RetransRequest>::iterator it = m_requests.find(seqNum);
+            if (it != m_requests.end())
+            {
+                // 한 번만 요청한 패킷만 RTT 표본으로 쓴다 (Karn 알고리즘)
+                if (it->second.m_attempts == 1)
                 {
-                    // 재전송요청 이후 들어온 패킷인 경우 => 1) 소비되지 않은 프레임인 경우 => 프레임사이즈에 추가 | 2) 이미 소비된 프레임인 경우 => 무시
-                    if (m_frameBuffer[frameNum] > 0)
-                    {
-                        m_frameBuffer[frameNum] += packet->GetSize();
-                    }
+                    Time sample = Simulator::Now() - it->second.m_sent;
+                    m_rtt.Update(sample);
+                    m_rttTrace(sample, m_rtt.GetSrtt());
                 }
+                m_retransTimers.Cancel(seqNum);
+                m_requests.erase(it);
             }
         }
+        if (m_reassembly.GetFrameState(frameNum) == VideoFrameReassembly::FRAME_COMPLETE)
+        {
+            // 새 패킷을 받은 순간 완성되었으므로 프레임마다 한 번만 호출된다
+            RecordComplete(frameNum);
+            m_frameCompleteTrace(frameNum, m_reassembly.GetFrameBytes(frameNum));
+        }
+
+        // 새로운 프레임이 시작되면 이전 프레임들까지, 가장 최근 프레임은 완성되면 버퍼에 등록
+        RecordFrameProgress(frameNum);
     }
 
-} // namespace ns3
\ No newline at end of file
+} // namespace ns3
@@ -7,11 +7,20 @@
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/address.h"
+#include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/video-stream-abr.h"
+#include "ns3/video-frame-reassembly.h"
+#include "ns3/video-stream-fec.h"
+#include "ns3/video-stream-control-header.h"
+#include "ns3/video-stream-rtt-estimator.h"
+#include "ns3/video-stream-timer-wheel.h"
 
+#include <functional>
 #include <queue>
-
-#define MAX_VIDEO_LEVEL 6
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -32,6 +41,76 @@ namespace ns3
      */
     static TypeId GetTypeId(void);
     VideoStreamClient();
+
+    /**
+     * @brief State of the playout of the frame buffer.
+     */
+    enum PlayoutState
+    {
+      PLAYOUT_BUFFERING, //!< Waiting for the initial delay and the start threshold
+      PLAYOUT_PLAYING,   //!< Playing one frame every 1/FrameRate
+      PLAYOUT_STALLED,   //!< Ran out of frames, waiting for the resume threshold
+      PLAYOUT_ENDED      //!< Played the last frame of the stream
+    };
+
+    /**
+     * TracedValue signature for a change of the playout state.
+     *
+     * @param [in] oldState the previous state
+     * @param [in] newState the new state
+     */
+    typedef void (*PlayoutStateCallback)(PlayoutState oldState, PlayoutState newState);
+
+    /**
+     * TracedCallback signature for a sequence number of the stream.
+     *
+     * @param [in] seqNum the sequence number
+     */
+    typedef void (*SeqNumCallback)(uint32_t seqNum);
+
+    /**
+     * TracedCallback signature for a completed frame.
+     *
+     * @param [in] frameNum the frame number
+     * @param [in] bytes the payload bytes of the frame
+     */
+    typedef void (*FrameCallback)(uint32_t frameNum, uint32_t bytes);
+
+    /**
+     * TracedCallback signature for a played frame. Exactly one of the
+     * counts is 1.
+     *
+     * @param [in] complete the frame was played with every packet
+     * @param [in] partial the frame was played with some packets missing
+     * @param [in] missing the frame was played without any packet
+     */
+    typedef void (*PlayoutCallback)(uint32_t complete, uint32_t partial, uint32_t missing);
+
+    /**
+     * TracedCallback signature for the latency of a complete frame, fired
+     * when it is played.
+     *
+     * @param [in] frameNum the frame number
+     * @param [in] sent the earliest send timestamp of the packets received for the frame
+     * @param [in] firstRx the arrival of the first packet of the frame
+     * @param [in] complete the time the last missing packet arrived or was recovered
+     * @param [in] lastOriginalRx the last arrival before completion that was not a
+     *             retransmission, or the first arrival if every packet was
+     */
+    typedef void (*FrameLatencyCallback)(uint32_t frameNum, Time sent, Time firstRx, Time complete, Time lastOriginalRx);
+
+    /**
+     * TracedCallback signature for the start of a stall.
+     */
+    typedef void (*StallStartCallback)(void);
+
+    /**
+     * TracedCallback signature for a round trip time sample.
+     *
+     * @param [in] sample the measured round trip time
+     * @param [in] srtt the smoothed round trip time after the sample
+     */
+    typedef void (*RttCallback)(Time sample, Time srtt);
     virtual ~VideoStreamClient();
 
     /**
@@ -52,26 +131,185 @@ namespace ns3
     virtual void DoDispose(void);
 
   private:
+    static const uint32_t REASSEMBLY_WINDOW = 4096; //!< Frames tracked ahead of the playout frame
+    static const uint32_t TIMER_WHEEL_SLOTS = 512;  //!< Slots of the retransmission timer wheel
+    static const uint32_t DECODE_HISTORY = 256;     //!< Played frames whose decodability is remembered, above the largest reference distance
+    static const uint32_t TIMING_HISTORY = 256;     //!< Frames whose arrival times are kept until they are played
+    static const uint32_t MAX_PENDING_PACKETS = 256; //!< Packets kept until the first frame is known
+
+    /**
+     * @brief State of a sequence number requested in a NACK.
+     */
+    struct RetransRequest
+    {
+      Time m_sent;         //!< Time of the last NACK carrying the sequence number
+      uint32_t m_attempts; //!< Number of NACKs that carried the sequence number
+    };
+
+    /**
+     * @brief Arrival times of a frame for the FrameLatency trace.
+     */
+    struct FrameTiming
+    {
+      uint32_t m_frameNum;   //!< Frame the entry belongs to
+      Time m_sent;           //!< Earliest send timestamp of the received packets
+      Time m_firstRx;        //!< First arrival
+      Time m_lastOriginalRx; //!< Last arrival that was not a retransmission
+      Time m_complete;       //!< Completion, Time::Max() while incomplete
+    };
+
     virtual void StartApplication(void);
     virtual void StopApplication(void);
 
     /**
-     * @brief Send the packet to the remote server.
+     * @brief Send the hello packet to the remote server.
      */
     void Send(void);
 
     /**
-     * @brief Send the packet to the remote server to require retransmission request.
+     * @brief Send a control packet to the server.
+     *
+     * @param packet the packet with the header of the message, if any
+     * @param type the message type to prepend
+     */
+    void SendControl(Ptr<Packet> packet, VideoStreamControlHeader::MessageType type);
+
+    /**
+     * @brief Send a keepalive if nothing was sent to the server for
+     * KeepaliveInterval, so the server does not time the stream out.
+     */
+    void SendKeepalive(void);
+
+    /**
+     * @brief Send one NACK packet covering the missing sequence numbers
+     * collected during the last feedback interval.
+     *
+     * With FEC a lost packet is only requested once a packet after its
+     * block arrived, so the parity of the block had its chance to recover it.
      */
     void SendRetransRequest(void);
 
     /**
-     * @brief Read data from the frame buffer. If the buffer does not have
-     * enough frames, it will reschedule the reading event next second.
+     * @brief Request a sequence number again when its retransmission did
+     * not arrive in time.
+     *
+     * Called by the timer wheel. The sequence number is given up after
+     * MaxRetransRequests NACKs or once its frame has been played.
+     *
+     * @param seqNum the requested sequence number
+     */
+    void HandleRetransTimeout(uint32_t seqNum);
+
+    /**
+     * @brief Whether a lost sequence number may hold a packet.
      *
-     * @return the updated buffer size (-1 if the buffer size is smaller than the fps)
+     * @param seqNum the sequence number
+     * @return false if the frame of seqNum is known to have fewer packets
      */
-    uint32_t ReadFromBuffer(void);
+    bool IsExpectedSeqNum(uint32_t seqNum) const;
+
+    /**
+     * @brief Get the time left until a frame is played.
+     *
+     * @param frameNum a frame that has not been played yet
+     * @return the playout deadline of the frame relative to now
+     */
+    Time GetFrameDeadline(uint32_t frameNum) const;
+
+    /**
+     * @brief Report the buffer occupancy, the measured throughput, the loss
+     * fraction and an echoed timestamp for the round trip time to the server.
+     *
+     * Sent every ReportInterval and once more when playout first starts,
+     * so a server in fast start learns the buffer is primed.
+     */
+    void SendReport(void);
+
+    /**
+     * @brief Play the next frame of the frame buffer and schedule the next
+     * one after 1/FrameRate, scaled by the playout rate.
+     *
+     * If the buffer is empty playout stalls at this frame and only resumes
+     * once the buffer reaches the resume threshold. Playout ends after the
+     * last frame of the stream.
+     */
+    void ReadFromBuffer(void);
+
+    /**
+     * @brief Count the frames waiting to be played.
+     *
+     * A frame is buffered once it is complete or a later frame has
+     * started. The last frame of the stream has no later frame, so it is
+     * buffered once any of its packets arrived.
+     */
+    void UpdateBufferLevel(void);
+
+    /**
+     * @brief Update the buffer after a packet of a frame was added, and
+     * start playing if the threshold is reached.
+     *
+     * @param frameNum the frame of the packet
+     */
+    void RecordFrameProgress(uint32_t frameNum);
+
+    /**
+     * @brief Select the playout rate from the buffer occupancy.
+     *
+     * With AdaptivePlayout frames are played at PlayoutSlowRate below the
+     * low watermark, at PlayoutFastRate above the high watermark and at
+     * the normal rate in between.
+     */
+    void UpdatePlayoutRate(void);
+
+    /**
+     * @return the time until the next frame at the current playout rate
+     */
+    Time GetPlayoutInterval(void) const;
+
+    /**
+     * @brief Start or resume playout if the buffer reached its threshold.
+     *
+     * Called when the initial delay ends and whenever the buffer grows
+     * while not playing.
+     */
+    void CheckPlayoutStart(void);
+
+    /**
+     * @brief Get the number of buffered frames needed to start playing.
+     *
+     * @param frames the threshold in frames
+     * @param time the threshold in playout time
+     * @return the larger of the two, in frames
+     */
+    uint32_t GetThresholdFrames(uint32_t frames, Time time) const;
+
+    /**
+     * @brief Record the arrival of a data or parity packet of a frame.
+     *
+     * @param frameNum the frame number
+     * @param sent the send timestamp of the packet
+     * @param retransmission whether the packet fills a gap that was already detected
+     */
+    void RecordArrival(uint32_t frameNum, Time sent, bool retransmission);
+
+    /**
+     * @brief Record that a frame was completely reassembled.
+     *
+     * @param frameNum the frame number
+     */
+    void RecordComplete(uint32_t frameNum);
+
+    /**
+     * @brief Decide whether a frame being played can be decoded.
+     *
+     * A complete frame is decodable if it is an I frame or its reference
+     * frame was decodable. Complete frames that are not are counted as
+     * undecodable.
+     *
+     * @param frameNum the frame being played
+     * @param state the state the frame was played in
+     */
+    void DecodeFrame(uint32_t frameNum, VideoFrameReassembly::FrameState state);
 
     /**
      * @brief Handle a packet reception.
@@ -82,27 +320,116 @@ namespace ns3
      */
     void HandleRead(Ptr<Socket> socket);
 
+    /**
+     * @brief Handle a packet of the stream.
+     *
+     * Packets received before the stream info are kept, since the
+     * sequence space is not known before; with multicast, so are parity
+     * and retransmitted packets received before the first data packet of
+     * the group, which sets the first frame.
+     *
+     * @param packet the packet, starting with its frame header
+     * @param fromGroup whether the packet was received on the multicast group socket
+     */
+    void HandlePacket(Ptr<Packet> packet, bool fromGroup);
+
+    /**
+     * @brief Adopt the stream constants sent by the server, once.
+     *
+     * @param packet the packet, after its frame header
+     */
+    void HandleStreamInfo(Ptr<Packet> packet);
+
+    /**
+     * @brief Handle the packets kept until the stream info or the first
+     * frame was known.
+     */
+    void HandlePendingPackets(void);
+
     Ptr<Socket> m_socket;  //!< Socket
+    Ptr<Socket> m_groupSocket; //!< Socket receiving the multicast stream
     Address m_peerAddress; //!< Remote peer address
     uint16_t m_peerPort;   //!< Remote peer port
 
-    uint16_t m_initialDelay;      //!< Seconds to wait before displaying the content
+    Time m_initialDelay;          //!< Time to wait before displaying the content
     uint32_t m_frameRate;         //!< Number of frames per second to be played
-    uint32_t m_frameSize;         //!< Total size of packets from one frame
+    Time m_frameInterval;         //!< Playout time of one frame, 1/m_frameRate
+    uint32_t m_startThreshold;    //!< Buffered frames needed to start playing
+    Time m_startThresholdTime;    //!< Buffered playout time needed to start playing
+    uint32_t m_resumeThreshold;   //!< Buffered frames needed to resume after a stall
+    Time m_resumeThresholdTime;   //!< Buffered playout time needed to resume after a stall
+    Time m_playoutStart;          //!< Earliest time playout may start
+    bool m_adaptivePlayout;       //!< Whether the playout rate follows the buffer occupancy
+    Time m_playoutLowWatermark;   //!< Buffered playout time below which frames are played slower
+    Time m_playoutHighWatermark;  //!< Buffered playout time above which frames are played faster
+    double m_playoutSlowRate;     //!< Playout rate below the low watermark
+    double m_playoutFastRate;     //!< Playout rate above the high watermark
+    TracedValue<double> m_playoutRate; //!< Current playout rate, 1 for the normal frame rate
     uint32_t m_lastRecvFrame;     //!< Last received frame number
     uint32_t m_currentBufferSize; //!< Size of the frame buffer
 
-    uint32_t m_packetNum;                 // frame당 패킷 개수
+    uint32_t m_packetNum;                 // frame당 예약된 seq 개수 (가장 큰 프레임의 패킷 개수)
     uint32_t m_expectedSeq;               // 받아야 되는 packet seq 번호 (0부터 시작)
-    uint32_t m_retransPktSize;            // 재전송 요청 패킷 사이즈
-    std::queue<uint32_t> m_retransBuffer; // 재전송 요청할 seq 번호를 담는 큐
-    uint32_t m_frameBuffer[32786];
-    uint32_t m_frameFront;
-    uint32_t m_frameBufferSize;
+    Time m_nackInterval;                  //!< NACK 피드백 주기
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> m_retransBuffer; // 재전송 요청할 seq 번호 (작은 번호부터)
+    std::unordered_map<uint32_t, RetransRequest> m_requests; //!< 응답을 기다리는 재전송 요청
+    VideoStreamTimerWheel m_retransTimers; //!< 재전송 요청별 타임아웃
+    VideoStreamRttEstimator m_rtt;        //!< NACK부터 재전송 도착까지의 RTT
+    Time m_rtoInitial;                    //!< Retransmission timeout before the first RTT sample
+    Time m_rtoMin;                        //!< Smallest retransmission timeout
+    Time m_rtoMax;                        //!< Largest retransmission timeout, including backoff
+    uint32_t m_maxRetransRequests;        //!< NACKs sent for one sequence number before giving up
+    Time m_lastTransit;                   //!< Transit time of the last new packet, for the jitter
+    TracedValue<Time> m_jitter;           //!< Interarrival jitter (RFC 3550)
+    VideoFrameReassembly m_reassembly;    //!< 프레임별 패킷 비트맵
+    TracedValue<uint32_t> m_frameBufferSize; //!< 재생 대기 중인 프레임 개수
+    std::vector<int16_t> m_frameRefs;     //!< 프레임별 참조 프레임까지의 거리, 모르면 -1 (m_reassembly와 같은 창)
+    std::vector<bool> m_decoded;          //!< 재생된 프레임의 디코딩 가능 여부 (DECODE_HISTORY개)
+    std::vector<FrameTiming> m_frameTimings; //!< 프레임별 도착 시각 (TIMING_HISTORY개, 프레임 번호로 순환)
+    TracedValue<PlayoutState> m_playoutState; //!< 재생 상태
+    Time m_stallStart;                    //!< Time the current stall started
 
-    EventId m_bufferEvent;  //!< Event to read from the buffer
+    EventId m_bufferEvent;  //!< Event to play the next frame, or the end of the initial delay
     EventId m_sendEvent;    //!< Event to send data to the server
     EventId m_retransEvent; //!< 재전송 요청 이벤트
+
+    Time m_reportInterval;  //!< Interval between two reports
+    Time m_lastReport;      //!< Time of the last report, or of the start
+    uint64_t m_reportBytes; //!< Bytes received since the last report
+    uint32_t m_reportLost;  //!< Sequence numbers skipped since the last report
+    uint32_t m_reportReceived; //!< New packets received since the last report
+    Time m_lastSendTs;      //!< Send timestamp of the last received packet
+    Time m_lastRecvTime;    //!< Arrival time of the last received packet
+    EventId m_reportEvent;  //!< Event to send the next report
+    Time m_keepaliveInterval; //!< Longest time without a packet to the server
+    Time m_lastTx;          //!< Time of the last packet sent to the server
+    EventId m_keepaliveEvent; //!< Event to check whether a keepalive is due
+
+    Ipv4Address m_multicastGroup; //!< Group the stream is received from, unicast if not a multicast address
+    uint16_t m_multicastPort;     //!< Port the group is received on
+    bool m_joined;                //!< Whether the first frame to play is known
+    bool m_infoReceived;          //!< Whether the stream info has been received
+    uint32_t m_totalFrames;       //!< Frames of the stream, 0 until the stream info is received
+    std::vector<std::pair<Ptr<Packet>, bool>> m_pendingPackets; //!< Packets received before the first frame was known, with whether they came from the group
+
+    bool m_enableNack;                   //!< Whether lost packets are requested again
+    VideoStreamFec::FecMode m_fecMode;   //!< Forward error correction code of the stream
+    uint32_t m_fecBlockSize;             //!< Source packets per FEC block, 0 for one block per frame
+    uint32_t m_fecParity;                //!< Reed-Solomon parity packets per block
+    VideoStreamFec m_fec;                //!< FEC block layout
+    TracedValue<uint64_t> m_fecRecovered; //!< Source packets recovered from parity packets
+
+    TracedCallback<Ptr<const Packet>> m_txTrace; //!< Hello, NACK and report packets sent
+    TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace; //!< Packets received, with the source
+    TracedCallback<uint32_t> m_retransRequestTrace; //!< Sequence numbers requested again
+    TracedCallback<uint32_t> m_retransRecvTrace; //!< Sequence numbers received after their gap was detected
+    TracedCallback<uint32_t, uint32_t> m_frameCompleteTrace; //!< Frames whose packets all arrived
+    TracedCallback<uint32_t, uint32_t, uint32_t> m_playoutTrace; //!< Frames played
+    TracedCallback<uint32_t, Time, Time, Time, Time> m_frameLatencyTrace; //!< Send and arrival times of complete frames when played
+    TracedCallback<uint32_t> m_undecodableTrace; //!< Complete frames played without their reference frame
+    TracedCallback<> m_stallStartTrace; //!< The buffer ran out of frames
+    TracedCallback<Time> m_stallEndTrace; //!< Playout resumed, with the stall duration
+    TracedCallback<Time, Time> m_rttTrace; //!< Round trip time samples of retransmission requests
   };
 
 } // namespace ns3
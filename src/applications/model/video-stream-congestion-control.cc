@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "video-stream-congestion-control.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamCongestionControl");
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamCongestionControl);
+
+    TypeId
+    VideoStreamCongestionControl::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamCongestionControl")
+                                .SetParent<Object>()
+                                .SetGroupName("Applications")
+                                .AddAttribute("MinRate", "The lowest rate the controller goes down to",
+                                              DataRateValue(DataRate("100kbps")),
+                                              MakeDataRateAccessor(&VideoStreamCongestionControl::m_minRate),
+                                              MakeDataRateChecker());
+        return tid;
+    }
+
+    VideoStreamCongestionControl::VideoStreamCongestionControl()
+        : m_rate(0),
+          m_packetSize(1400)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    VideoStreamCongestionControl::~VideoStreamCongestionControl()
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    void
+    VideoStreamCongestionControl::Init(DataRate initialRate, uint32_t packetSize)
+    {
+        NS_LOG_FUNCTION(this << initialRate << packetSize);
+        m_packetSize = packetSize;
+        m_srtt = Time();
+        SetRate(initialRate.GetBitRate());
+    }
+
+    DataRate
+    VideoStreamCongestionControl::GetRate(void) const
+    {
+        return DataRate(static_cast<uint64_t>(m_rate));
+    }
+
+    uint32_t
+    VideoStreamCongestionControl::GetCongestionWindow(void) const
+    {
+        return static_cast<uint32_t>(std::min(m_rate * m_srtt.GetSeconds() / 8, 4294967295.0));
+    }
+
+    void
+    VideoStreamCongestionControl::UpdateRtt(Time rtt)
+    {
+        if (!rtt.IsStrictlyPositive())
+        {
+            return;
+        }
+        // RFC 5348 4.3과 같은 지수 이동 평균 (q = 0.9)
+        m_srtt = m_srtt.IsZero() ? rtt : Seconds(0.9 * m_srtt.GetSeconds() + 0.1 * rtt.GetSeconds());
+    }
+
+    void
+    VideoStreamCongestionControl::SetRate(double rate)
+    {
+        m_rate = std::max<double>(rate, m_minRate.GetBitRate());
+    }
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamTfrc);
+
+    TypeId
+    VideoStreamTfrc::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamTfrc")
+                                .SetParent<VideoStreamCongestionControl>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<VideoStreamTfrc>();
+        return tid;
+    }
+
+    VideoStreamTfrc::VideoStreamTfrc()
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    std::string
+    VideoStreamTfrc::GetName(void) const
+    {
+        return "Tfrc";
+    }
+
+    void
+    VideoStreamTfrc::OnReport(double lossFraction, Time rtt, DataRate receiveRate)
+    {
+        NS_LOG_FUNCTION(this << lossFraction << rtt << receiveRate);
+
+        UpdateRtt(rtt);
+        double receive = receiveRate.GetBitRate();
+        if (lossFraction <= 0)
+        {
+            // 손실이 없으면 slow start처럼 받은 속도의 두 배까지 늘린다
+            SetRate(std::min(2 * m_rate, std::max(2 * receive, m_rate)));
+            return;
+        }
+
+        double s = m_packetSize * 8.0;
+        double r = m_srtt.IsZero() ? 0.1 : m_srtt.GetSeconds();
+        double p = lossFraction;
+        double tRto = 4 * r;
+        double x = s / (r * std::sqrt(2 * p / 3) + tRto * (3 * std::sqrt(3 * p / 8)) * p * (1 + 32 * p * p));
+        SetRate(std::max(std::min(x, 2 * receive), s / 64));
+    }
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamDelayBased);
+
+    TypeId
+    VideoStreamDelayBased::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamDelayBased")
+                                .SetParent<VideoStreamCongestionControl>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<VideoStreamDelayBased>()
+                                .AddAttribute("TargetDelay", "The queuing delay above which the rate decreases",
+                                              TimeValue(MilliSeconds(25)),
+                                              MakeTimeAccessor(&VideoStreamDelayBased::m_targetDelay),
+                                              MakeTimeChecker())
+                                .AddAttribute("LossThreshold", "The loss fraction above which the rate decreases",
+                                              DoubleValue(0.1),
+                                              MakeDoubleAccessor(&VideoStreamDelayBased::m_lossThreshold),
+                                              MakeDoubleChecker<double>(0.0, 1.0))
+                                .AddAttribute("Increase", "The rate factor per report without congestion",
+                                              DoubleValue(1.08),
+                                              MakeDoubleAccessor(&VideoStreamDelayBased::m_increase),
+                                              MakeDoubleChecker<double>(1.0))
+                                .AddAttribute("Decrease", "The rate factor per report with congestion",
+                                              DoubleValue(0.85),
+                                              MakeDoubleAccessor(&VideoStreamDelayBased::m_decrease),
+                                              MakeDoubleChecker<double>(0.0, 1.0));
+        return tid;
+    }
+
+    VideoStreamDelayBased::VideoStreamDelayBased()
+        : m_minRtt(Time::Max())
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    std::string
+    VideoStreamDelayBased::GetName(void) const
+    {
+        return "DelayBased";
+    }
+
+    void
+    VideoStreamDelayBased::OnReport(double lossFraction, Time rtt, DataRate receiveRate)
+    {
+        NS_LOG_FUNCTION(this << lossFraction << rtt << receiveRate);
+
+        UpdateRtt(rtt);
+        Time queuing = Time();
+        if (rtt.IsStrictlyPositive())
+        {
+            m_minRtt = std::min(m_minRtt, rtt);
+            queuing = rtt - m_minRtt;
+        }
+
+        if (queuing > m_targetDelay || lossFraction > m_lossThreshold)
+        {
+            SetRate(m_rate * m_decrease);
+        }
+        else
+        {
+            // 보내지 않은 속도까지 계속 올라가지 않도록 받은 속도의 두 배로 제한
+            SetRate(std::min(m_rate * m_increase, std::max(2.0 * receiveRate.GetBitRate(), m_rate)));
+        }
+    }
+
+} // namespace ns3
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_CONGESTION_CONTROL_H
+#define VIDEO_STREAM_CONGESTION_CONTROL_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+
+#include <string>
+
+namespace ns3
+{
+
+    /**
+     * @brief Interface of the congestion controllers of the video stream.
+     *
+     * The server keeps one controller per client and feeds it the loss
+     * fraction, round trip time and receive rate of every client report.
+     * The resulting rate caps the pacing rate and the video level of the
+     * client. New algorithms derive from this class and are selected by
+     * type name with the CongestionControl attribute of the server.
+     */
+    class VideoStreamCongestionControl : public Object
+    {
+    public:
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamCongestionControl();
+        virtual ~VideoStreamCongestionControl();
+
+        /**
+         * @return the name of the algorithm
+         */
+        virtual std::string GetName(void) const = 0;
+
+        /**
+         * @brief Start the controller.
+         *
+         * @param initialRate the rate before the first report
+         * @param packetSize the size of a full packet in bytes
+         */
+        void Init(DataRate initialRate, uint32_t packetSize);
+
+        /**
+         * @brief Update the rate from a client report.
+         *
+         * @param lossFraction fraction of the packets lost since the last report
+         * @param rtt round trip time measured with the report, zero if unknown
+         * @param receiveRate rate the client received at since the last report
+         */
+        virtual void OnReport(double lossFraction, Time rtt, DataRate receiveRate) = 0;
+
+        /**
+         * @return the allowed sending rate
+         */
+        DataRate GetRate(void) const;
+
+        /**
+         * @return the bytes in flight the rate allows over one smoothed round trip time
+         */
+        uint32_t GetCongestionWindow(void) const;
+
+    protected:
+        /**
+         * @brief Fold a round trip time sample into the smoothed round trip time.
+         *
+         * @param rtt the sample, ignored if zero
+         */
+        void UpdateRtt(Time rtt);
+
+        /**
+         * @brief Set the rate, never below MinRate.
+         *
+         * @param rate the new rate in bit/s
+         */
+        void SetRate(double rate);
+
+        double m_rate;         //!< Allowed sending rate in bit/s
+        uint32_t m_packetSize; //!< Full packet size in bytes
+        Time m_srtt;           //!< Smoothed round trip time, zero until the first sample
+        DataRate m_minRate;    //!< Lowest rate the controller goes down to
+    };
+
+    /**
+     * @brief TCP-friendly rate control (RFC 5348).
+     *
+     * The rate follows the TCP throughput equation of the reported loss
+     * fraction and round trip time, limited to twice the receive rate.
+     * Without loss the rate doubles every report, as in TFRC slow start.
+     */
+    class VideoStreamTfrc : public VideoStreamCongestionControl
+    {
+    public:
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamTfrc();
+
+        virtual std::string GetName(void) const;
+        virtual void OnReport(double lossFraction, Time rtt, DataRate receiveRate);
+    };
+
+    /**
+     * @brief Delay-based congestion control.
+     *
+     * The queuing delay is the round trip time above the smallest one seen.
+     * The rate is multiplied by Decrease when the queuing delay exceeds
+     * TargetDelay or the loss fraction exceeds LossThreshold, and by
+     * Increase otherwise, up to twice the receive rate.
+     */
+    class VideoStreamDelayBased : public VideoStreamCongestionControl
+    {
+    public:
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamDelayBased();
+
+        virtual std::string GetName(void) const;
+        virtual void OnReport(double lossFraction, Time rtt, DataRate receiveRate);
+
+    private:
+        Time m_targetDelay;     //!< Queuing delay above which the rate decreases
+        double m_lossThreshold; //!< Loss fraction above which the rate decreases
+        double m_increase;      //!< Rate factor per report without congestion
+        double m_decrease;      //!< Rate factor per report with congestion
+        Time m_minRtt;          //!< Smallest round trip time seen
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_CONGESTION_CONTROL_H */
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-stream-control-header.h"
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamControlHeader");
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamControlHeader);
+
+    TypeId
+    VideoStreamControlHeader::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamControlHeader")
+                                .SetParent<Header>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<VideoStreamControlHeader>();
+        return tid;
+    }
+
+    VideoStreamControlHeader::VideoStreamControlHeader()
+        : m_type(0)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    VideoStreamControlHeader::VideoStreamControlHeader(MessageType type)
+        : m_type(type)
+    {
+        NS_LOG_FUNCTION(this << type);
+    }
+
+    void
+    VideoStreamControlHeader::SetMessageType(MessageType type)
+    {
+        m_type = type;
+    }
+
+    VideoStreamControlHeader::MessageType
+    VideoStreamControlHeader::GetMessageType(void) const
+    {
+        return static_cast<MessageType>(m_type);
+    }
+
+    TypeId
+    VideoStreamControlHeader::GetInstanceTypeId(void) const
+    {
+        return GetTypeId();
+    }
+
+    void
+    VideoStreamControlHeader::Print(std::ostream &os) const
+    {
+        switch (m_type)
+        {
+        case HELLO:
+            os << "HELLO";
+            break;
+        case NACK:
+            os << "NACK";
+            break;
+        case REPORT:
+            os << "REPORT";
+            break;
+        case BYE:
+            os << "BYE";
+            break;
+        case KEEPALIVE:
+            os << "KEEPALIVE";
+            break;
+        default:
+            os << "UNKNOWN(" << +m_type << ")";
+            break;
+        }
+    }
+
+    uint32_t
+    VideoStreamControlHeader::GetSerializedSize(void) const
+    {
+        return 2;
+    }
+
+    void
+    VideoStreamControlHeader::Serialize(Buffer::Iterator start) const
+    {
+        Buffer::Iterator i = start;
+        i.WriteU8(m_type);
+        i.WriteU8(0);
+    }
+
+    uint32_t
+    VideoStreamControlHeader::Deserialize(Buffer::Iterator start)
+    {
+        Buffer::Iterator i = start;
+        m_type = i.ReadU8();
+        i.ReadU8();
+        return GetSerializedSize();
+    }
+
+} // namespace ns3
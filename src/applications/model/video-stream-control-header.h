@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_CONTROL_HEADER_H
+#define VIDEO_STREAM_CONTROL_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3
+{
+
+    /**
+     * @brief Type of a control packet sent by a video stream client.
+     *
+     * Every packet from the client to the server starts with this header.
+     * A NACK is followed by a VideoStreamNackHeader and a report by a
+     * VideoStreamReportHeader; hello, bye and keepalive carry nothing else.
+     *
+     * Layout: message type (1 byte) | reserved (1 byte)
+     */
+    class VideoStreamControlHeader : public Header
+    {
+    public:
+        enum MessageType
+        {
+            HELLO = 1,     //!< Start a stream
+            NACK = 2,      //!< Request lost packets again
+            REPORT = 3,    //!< Periodic buffer, throughput and loss report
+            BYE = 4,       //!< End the stream
+            KEEPALIVE = 5  //!< Keep the stream alive while nothing else is sent
+        };
+
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamControlHeader();
+
+        /**
+         * @param type the message type
+         */
+        explicit VideoStreamControlHeader(MessageType type);
+
+        /**
+         * @param type the message type
+         */
+        void SetMessageType(MessageType type);
+        /**
+         * @return the message type, as received, so it may be unknown
+         */
+        MessageType GetMessageType(void) const;
+
+        virtual TypeId GetInstanceTypeId(void) const;
+        virtual void Print(std::ostream &os) const;
+        virtual uint32_t GetSerializedSize(void) const;
+        virtual void Serialize(Buffer::Iterator start) const;
+        virtual uint32_t Deserialize(Buffer::Iterator start);
+
+    private:
+        uint8_t m_type; //!< MessageType of the packet
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_CONTROL_HEADER_H */
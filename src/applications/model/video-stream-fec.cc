@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "video-stream-fec.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamFec");
+
+    VideoStreamFec::VideoStreamFec()
+        : m_mode(FEC_NONE),
+          m_packetsPerFrame(1),
+          m_blockSize(0),
+          m_parity(0)
+    {
+    }
+
+    void
+    VideoStreamFec::Setup(FecMode mode, uint32_t packetsPerFrame, uint32_t blockSize, uint32_t parity)
+    {
+        NS_LOG_FUNCTION(this << mode << packetsPerFrame << blockSize << parity);
+        m_mode = mode;
+        m_packetsPerFrame = std::max<uint32_t>(packetsPerFrame, 1);
+        m_blockSize = blockSize;
+        switch (mode)
+        {
+        case FEC_XOR:
+            m_parity = 1;
+            break;
+        case FEC_REED_SOLOMON:
+            m_parity = std::max<uint32_t>(parity, 1);
+            break;
+        default:
+            m_parity = 0;
+            break;
+        }
+        NS_ABORT_MSG_IF(GetBlocksPerFrame(m_packetsPerFrame) * m_parity > 0xff, "Too many parity packets per frame");
+    }
+
+    bool
+    VideoStreamFec::IsEnabled(void) const
+    {
+        return m_parity > 0;
+    }
+
+    uint32_t
+    VideoStreamFec::GetPacketsPerFrame(void) const
+    {
+        return m_packetsPerFrame;
+    }
+
+    uint32_t
+    VideoStreamFec::GetBlocksPerFrame(uint32_t packets) const
+    {
+        uint32_t blockSize = GetBlockSize(packets);
+        return (packets + blockSize - 1) / blockSize;
+    }
+
+    uint32_t
+    VideoStreamFec::GetParityPerBlock(void) const
+    {
+        return m_parity;
+    }
+
+    uint32_t
+    VideoStreamFec::GetBlock(uint32_t index, uint32_t packets) const
+    {
+        return index / GetBlockSize(packets);
+    }
+
+    uint32_t
+    VideoStreamFec::GetBlockStart(uint32_t block, uint32_t packets) const
+    {
+        return block * GetBlockSize(packets);
+    }
+
+    uint32_t
+    VideoStreamFec::GetBlockLength(uint32_t block, uint32_t packets) const
+    {
+        return std::min(GetBlockSize(packets), packets - GetBlockStart(block, packets));
+    }
+
+    bool
+    VideoStreamFec::IsBlockEnd(uint32_t index, uint32_t packets) const
+    {
+        uint32_t blockSize = GetBlockSize(packets);
+        return index % blockSize == blockSize - 1 || index == packets - 1;
+    }
+
+    uint32_t
+    VideoStreamFec::GetBlockSize(uint32_t packets) const
+    {
+        packets = std::max<uint32_t>(packets, 1);
+        return (m_blockSize == 0) ? packets : std::min(m_blockSize, packets);
+    }
+
+    bool
+    VideoStreamFec::IsParitySeqNum(uint32_t seqNum)
+    {
+        return (seqNum & PARITY_SEQ_FLAG) != 0;
+    }
+
+    uint32_t
+    VideoStreamFec::MakeParitySeqNum(uint32_t frameNum, uint32_t parityIndex)
+    {
+        NS_ASSERT_MSG(frameNum < MAX_PARITY_FRAMES && parityIndex < MAX_PARITY_PER_FRAME, "Parity packet " << parityIndex << " of frame " << frameNum << " does not fit in a sequence number");
+        return PARITY_SEQ_FLAG | (frameNum << 8) | parityIndex;
+    }
+
+    uint32_t
+    VideoStreamFec::GetParityFrame(uint32_t seqNum)
+    {
+        return (seqNum & ~PARITY_SEQ_FLAG) >> 8;
+    }
+
+    uint32_t
+    VideoStreamFec::GetParityIndex(uint32_t seqNum)
+    {
+        return seqNum & 0xff;
+    }
+
+} // namespace ns3
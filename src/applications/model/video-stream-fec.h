@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_FEC_H
+#define VIDEO_STREAM_FEC_H
+
+#include <stdint.h>
+
+namespace ns3
+{
+
+    /**
+     * @brief Layout of the forward error correction of the video stream.
+     *
+     * The packets of a frame are split into blocks of up to BlockSize
+     * packets (the whole frame if BlockSize is 0) and every block is
+     * followed by parity packets: one for XOR, Parity for Reed-Solomon.
+     * Both are treated as MDS erasure codes, so a block is recovered as
+     * soon as the number of received source and parity packets reaches the
+     * number of source packets. Payloads are virtual, so only this counting
+     * is simulated, not the coding itself. Frames may have different
+     * numbers of packets, so the layout of a frame depends on its size.
+     *
+     * Parity packets use their own sequence numbers: the most significant
+     * bit is set and the rest holds (frame number << 8) | parity index,
+     * where parity index = block * parity per block + j.
+     */
+    class VideoStreamFec
+    {
+    public:
+        enum FecMode
+        {
+            FEC_NONE,        //!< No parity packets
+            FEC_XOR,         //!< One XOR parity packet per block
+            FEC_REED_SOLOMON //!< Parity Reed-Solomon parity packets per block
+        };
+
+        static const uint32_t PARITY_SEQ_FLAG = 0x80000000; //!< Marks a parity sequence number
+        static const uint32_t MAX_PARITY_FRAMES = 1 << 23;  //!< Frames whose parity sequence numbers fit below the flag
+        static const uint32_t MAX_PARITY_PER_FRAME = 1 << 8; //!< Parity packets per frame of the 8-bit parity index
+
+        VideoStreamFec();
+
+        /**
+         * @brief Configure the code.
+         *
+         * @param mode the code
+         * @param packetsPerFrame the largest number of source packets of a frame
+         * @param blockSize source packets per block, 0 for one block per frame
+         * @param parity parity packets per block for Reed-Solomon
+         */
+        void Setup(FecMode mode, uint32_t packetsPerFrame, uint32_t blockSize, uint32_t parity);
+
+        /**
+         * @return true if parity packets are sent
+         */
+        bool IsEnabled(void) const;
+
+        /**
+         * @return the largest number of source packets of a frame
+         */
+        uint32_t GetPacketsPerFrame(void) const;
+
+        /**
+         * @param packets the number of source packets of the frame
+         * @return the number of blocks of the frame
+         */
+        uint32_t GetBlocksPerFrame(uint32_t packets) const;
+
+        /**
+         * @return the number of parity packets per block
+         */
+        uint32_t GetParityPerBlock(void) const;
+
+        /**
+         * @param index index of a source packet inside its frame
+         * @param packets the number of source packets of the frame
+         * @return the block of the packet
+         */
+        uint32_t GetBlock(uint32_t index, uint32_t packets) const;
+
+        /**
+         * @param block a block of a frame
+         * @param packets the number of source packets of the frame
+         * @return index of the first source packet of the block
+         */
+        uint32_t GetBlockStart(uint32_t block, uint32_t packets) const;
+
+        /**
+         * @param block a block of a frame
+         * @param packets the number of source packets of the frame
+         * @return the number of source packets of the block
+         */
+        uint32_t GetBlockLength(uint32_t block, uint32_t packets) const;
+
+        /**
+         * @param index index of a source packet inside its frame
+         * @param packets the number of source packets of the frame
+         * @return true if the packet is the last source packet of its block
+         */
+        bool IsBlockEnd(uint32_t index, uint32_t packets) const;
+
+        static bool IsParitySeqNum(uint32_t seqNum);
+        static uint32_t MakeParitySeqNum(uint32_t frameNum, uint32_t parityIndex);
+        static uint32_t GetParityFrame(uint32_t seqNum);
+        static uint32_t GetParityIndex(uint32_t seqNum);
+
+    private:
+        /**
+         * @param packets the number of source packets of the frame
+         * @return the number of source packets of a full block of the frame
+         */
+        uint32_t GetBlockSize(uint32_t packets) const;
+
+        FecMode m_mode;
+        uint32_t m_packetsPerFrame;
+        uint32_t m_blockSize; //!< Source packets per block, 0 for one block per frame
+        uint32_t m_parity;
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_FEC_H */
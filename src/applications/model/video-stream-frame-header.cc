@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "video-stream-frame-header.h"
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamFrameHeader");
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamFrameHeader);
+
+    TypeId
+    VideoStreamFrameHeader::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamFrameHeader")
+                                .SetParent<Header>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<VideoStreamFrameHeader>();
+        return tid;
+    }
+
+    VideoStreamFrameHeader::VideoStreamFrameHeader()
+        : m_frameNum(0),
+          m_index(0),
+          m_framePackets(0),
+          m_flags(FRAME_I),
+          m_timestampUs(0)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    void
+    VideoStreamFrameHeader::SetFrameNum(uint32_t frameNum)
+    {
+        NS_ASSERT_MSG(frameNum <= MAX_FRAME_NUM, "Frame number " << frameNum << " does not fit in 24 bits");
+        m_frameNum = frameNum;
+    }
+
+    uint32_t
+    VideoStreamFrameHeader::GetFrameNum(void) const
+    {
+        return m_frameNum;
+    }
+
+    void
+    VideoStreamFrameHeader::SetPacketIndex(uint16_t index)
+    {
+        m_index = index;
+    }
+
+    uint16_t
+    VideoStreamFrameHeader::GetPacketIndex(void) const
+    {
+        return m_index;
+    }
+
+    void
+    VideoStreamFrameHeader::SetParity(bool parity)
+    {
+        m_flags = parity ? (m_flags | PARITY_FLAG) : (m_flags & ~PARITY_FLAG);
+    }
+
+    bool
+    VideoStreamFrameHeader::IsParity(void) const
+    {
+        return (m_flags & PARITY_FLAG) != 0;
+    }
+
+    void
+    VideoStreamFrameHeader::SetInfo(bool info)
+    {
+        m_flags = info ? (m_flags | INFO_FLAG) : (m_flags & ~INFO_FLAG);
+    }
+
+    bool
+    VideoStreamFrameHeader::IsInfo(void) const
+    {
+        return (m_flags & INFO_FLAG) != 0;
+    }
+
+    void
+    VideoStreamFrameHeader::SetTimestamp(Time timestamp)
+    {
+        m_timestampUs = static_cast<uint32_t>(timestamp.GetMicroSeconds()) & TIMESTAMP_MASK;
+    }
+
+    Time
+    VideoStreamFrameHeader::GetTimestamp(Time now) const
+    {
+        // 24비트 마이크로초는 약 16.7초마다 한 바퀴 돌므로 현재 시각과의 차이로 되돌린다
+        uint32_t elapsed = (static_cast<uint32_t>(now.GetMicroSeconds()) - m_timestampUs) & TIMESTAMP_MASK;
+        return now - MicroSeconds(elapsed);
+    }
+
+    void
+    VideoStreamFrameHeader::SetFramePackets(uint16_t packets)
+    {
+        m_framePackets = packets;
+    }
+
+    uint16_t
+    VideoStreamFrameHeader::GetFramePackets(void) const
+    {
+        return m_framePackets;
+    }
+
+    void
+    VideoStreamFrameHeader::SetFrameType(FrameType type)
+    {
+        m_flags = (m_flags & ~TYPE_MASK) | (type & TYPE_MASK);
+    }
+
+    VideoStreamFrameHeader::FrameType
+    VideoStreamFrameHeader::GetFrameType(void) const
+    {
+        return static_cast<FrameType>(m_flags & TYPE_MASK);
+    }
+
+    void
+    VideoStreamFrameHeader::SetRefDistance(uint8_t distance)
+    {
+        NS_ASSERT_MSG(distance <= MAX_REF_DISTANCE, "Reference distance " << +distance << " does not fit in 4 bits");
+        m_flags = (m_flags & ~(MAX_REF_DISTANCE << REF_SHIFT)) | (distance << REF_SHIFT);
+    }
+
+    uint8_t
+    VideoStreamFrameHeader::GetRefDistance(void) const
+    {
+        return m_flags >> REF_SHIFT;
+    }
+
+    TypeId
+    VideoStreamFrameHeader::GetInstanceTypeId(void) const
+    {
+        return GetTypeId();
+    }
+
+    void
+    VideoStreamFrameHeader::Print(std::ostream &os) const
+    {
+        os << "(frame=" << m_frameNum << (IsParity() ? " parity=" : " index=") << m_index << " packets=" << m_framePackets
+           << (IsInfo() ? " info" : "") << " type=" << "IPB"[GetFrameType() % 3] << " ref=-" << +GetRefDistance() << " ts=" << m_timestampUs << "us)";
+    }
+
+    uint32_t
+    VideoStreamFrameHeader::GetSerializedSize(void) const
+    {
+        return 11;
+    }
+
+    void
+    VideoStreamFrameHeader::Serialize(Buffer::Iterator start) const
+    {
+        Buffer::Iterator i = start;
+        i.WriteU8(m_frameNum >> 16);
+        i.WriteHtonU16(m_frameNum & 0xffff);
+        i.WriteHtonU16(m_index);
+        i.WriteHtonU16(m_framePackets);
+        i.WriteU8(m_flags);
+        i.WriteU8(m_timestampUs >> 16);
+        i.WriteHtonU16(m_timestampUs & 0xffff);
+    }
+
+    uint32_t
+    VideoStreamFrameHeader::Deserialize(Buffer::Iterator start)
+    {
+        Buffer::Iterator i = start;
+        m_frameNum = static_cast<uint32_t>(i.ReadU8()) << 16;
+        m_frameNum |= i.ReadNtohU16();
+        m_index = i.ReadNtohU16();
+        m_framePackets = i.ReadNtohU16();
+        m_flags = i.ReadU8();
+        m_timestampUs = static_cast<uint32_t>(i.ReadU8()) << 16;
+        m_timestampUs |= i.ReadNtohU16();
+        return GetSerializedSize();
+    }
+
+} // namespace ns3
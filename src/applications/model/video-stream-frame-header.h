@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_FRAME_HEADER_H
+#define VIDEO_STREAM_FRAME_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+
+    /**
+     * @brief The only header of every data and parity packet of the stream.
+     *
+     * A packet is identified by its frame number and its index within the
+     * frame, or within the parity packets of the frame if the parity flag
+     * is set, so the client places it without dividing a sequence number.
+     * Frame f still owns the sequence numbers [f * stride, (f + 1) * stride)
+     * that NACKs refer to, of which only the first `packets` are sent. The
+     * stride is a constant of the stream and travels once in a
+     * VideoStreamInfoHeader, after a frame header with the info flag.
+     *
+     * The reference distance is the number of frames back to the I or P
+     * frame the frame is predicted from, 0 for an I frame, so the client
+     * can tell which frames a lost reference frame makes undecodable. It
+     * shares the flags byte and is at most MAX_REF_DISTANCE.
+     *
+     * The send timestamp is kept in microseconds modulo 2^24, so it wraps
+     * every 16.77 s. A packet must reach the client less than that after it
+     * was sent, which holds for the transit time and the echo of the reports.
+     *
+     * Layout: frame number (3 bytes) | packet index (2 bytes) | packets of the frame (2 bytes) |
+     *         flags: frame type (bits 0-1), parity (bit 2), info (bit 3), reference distance (bits 4-7) (1 byte) |
+     *         send timestamp in us (3 bytes)
+     *
+     * The 11 bytes replace the 12-byte SeqTsHeader and the 6-byte frame
+     * header that used to follow it.
+     */
+    class VideoStreamFrameHeader : public Header
+    {
+    public:
+        enum FrameType
+        {
+            FRAME_I, //!< Intra coded frame
+            FRAME_P, //!< Predicted frame
+            FRAME_B  //!< Bidirectionally predicted frame
+        };
+
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamFrameHeader();
+
+        /**
+         * @param frameNum the frame number, below 2^24
+         */
+        void SetFrameNum(uint32_t frameNum);
+        /**
+         * @return the frame number
+         */
+        uint32_t GetFrameNum(void) const;
+
+        /**
+         * @param index the index of the packet among the source or parity packets of the frame
+         */
+        void SetPacketIndex(uint16_t index);
+        /**
+         * @return the index of the packet among the source or parity packets of the frame
+         */
+        uint16_t GetPacketIndex(void) const;
+
+        /**
+         * @param parity whether the packet is a parity packet
+         */
+        void SetParity(bool parity);
+        /**
+         * @return true if the packet is a parity packet
+         */
+        bool IsParity(void) const;
+
+        /**
+         * @param info whether a VideoStreamInfoHeader follows instead of a payload
+         */
+        void SetInfo(bool info);
+        /**
+         * @return true if a VideoStreamInfoHeader follows instead of a payload
+         */
+        bool IsInfo(void) const;
+
+        /**
+         * @param timestamp the send time of the packet
+         */
+        void SetTimestamp(Time timestamp);
+        /**
+         * @param now the current time, less than 2^24 us after the send time
+         * @return the send time of the packet
+         */
+        Time GetTimestamp(Time now) const;
+
+        /**
+         * @param packets the number of source packets of the frame
+         */
+        void SetFramePackets(uint16_t packets);
+        /**
+         * @return the number of source packets of the frame
+         */
+        uint16_t GetFramePackets(void) const;
+
+        /**
+         * @param type the coding type of the frame
+         */
+        void SetFrameType(FrameType type);
+        /**
+         * @return the coding type of the frame
+         */
+        FrameType GetFrameType(void) const;
+
+        /**
+         * @param distance the number of frames back to the reference frame, 0 for none,
+         * at most MAX_REF_DISTANCE
+         */
+        void SetRefDistance(uint8_t distance);
+        /**
+         * @return the number of frames back to the reference frame, 0 for none
+         */
+        uint8_t GetRefDistance(void) const;
+
+        virtual TypeId GetInstanceTypeId(void) const;
+        virtual void Print(std::ostream &os) const;
+        virtual uint32_t GetSerializedSize(void) const;
+        virtual void Serialize(Buffer::Iterator start) const;
+        virtual uint32_t Deserialize(Buffer::Iterator start);
+
+        static const uint8_t MAX_REF_DISTANCE = 15; //!< Largest reference distance of the 4 flag bits
+
+    private:
+        static const uint32_t MAX_FRAME_NUM = 0xffffff; //!< Largest frame number of the 3-byte field
+        static const uint8_t TYPE_MASK = 0x03;   //!< Flag bits of the frame type
+        static const uint8_t PARITY_FLAG = 0x04; //!< Flag bit of parity packets
+        static const uint8_t INFO_FLAG = 0x08;   //!< Flag bit of stream info packets
+        static const uint8_t REF_SHIFT = 4;      //!< First flag bit of the reference distance
+        static const uint32_t TIMESTAMP_MASK = 0xffffff; //!< Bits of the 3-byte timestamp
+
+        uint32_t m_frameNum;     //!< Frame number
+        uint16_t m_index;        //!< Packet index within the frame
+        uint16_t m_framePackets; //!< Source packets of the frame
+        uint8_t m_flags;         //!< Frame type, parity and info flags and reference distance
+        uint32_t m_timestampUs;  //!< Send time in us modulo 2^24
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_FRAME_HEADER_H */
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-stream-info-header.h"
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamInfoHeader");
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamInfoHeader);
+
+    TypeId
+    VideoStreamInfoHeader::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamInfoHeader")
+                                .SetParent<Header>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<VideoStreamInfoHeader>();
+        return tid;
+    }
+
+    VideoStreamInfoHeader::VideoStreamInfoHeader()
+        : m_stride(0),
+          m_frames(0)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    void
+    VideoStreamInfoHeader::SetStride(uint16_t stride)
+    {
+        m_stride = stride;
+    }
+
+    uint16_t
+    VideoStreamInfoHeader::GetStride(void) const
+    {
+        return m_stride;
+    }
+
+    void
+    VideoStreamInfoHeader::SetFrameCount(uint32_t frames)
+    {
+        m_frames = frames;
+    }
+
+    uint32_t
+    VideoStreamInfoHeader::GetFrameCount(void) const
+    {
+        return m_frames;
+    }
+
+    TypeId
+    VideoStreamInfoHeader::GetInstanceTypeId(void) const
+    {
+        return GetTypeId();
+    }
+
+    void
+    VideoStreamInfoHeader::Print(std::ostream &os) const
+    {
+        os << "(stride=" << m_stride << " frames=" << m_frames << ")";
+    }
+
+    uint32_t
+    VideoStreamInfoHeader::GetSerializedSize(void) const
+    {
+        return 8;
+    }
+
+    void
+    VideoStreamInfoHeader::Serialize(Buffer::Iterator start) const
+    {
+        Buffer::Iterator i = start;
+        i.WriteHtonU16(m_stride);
+        i.WriteHtonU16(0);
+        i.WriteHtonU32(m_frames);
+    }
+
+    uint32_t
+    VideoStreamInfoHeader::Deserialize(Buffer::Iterator start)
+    {
+        Buffer::Iterator i = start;
+        m_stride = i.ReadNtohU16();
+        i.ReadNtohU16();
+        m_frames = i.ReadNtohU32();
+        return GetSerializedSize();
+    }
+
+} // namespace ns3
@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_INFO_HEADER_H
+#define VIDEO_STREAM_INFO_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3
+{
+
+    /**
+     * @brief Constants of a stream, sent by the server once per client.
+     *
+     * The server sends it after the HELLO that starts a stream, and again
+     * for every later HELLO of the same client, so a client that lost it
+     * asks again. It follows a VideoStreamFrameHeader with the info flag.
+     *
+     * The stride is the number of sequence numbers reserved for each frame:
+     * frame f owns [f * stride, (f + 1) * stride). It is the same for
+     * every packet, so it is not repeated in the frame header.
+     *
+     * The frame count tells the client which frame is the last one, so it
+     * ends the playout there instead of waiting for more frames.
+     *
+     * Layout: sequence numbers per frame (2 bytes) | reserved (2 bytes) | frames of the stream (4 bytes)
+     */
+    class VideoStreamInfoHeader : public Header
+    {
+    public:
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamInfoHeader();
+
+        /**
+         * @param stride the number of sequence numbers reserved for each frame
+         */
+        void SetStride(uint16_t stride);
+        /**
+         * @return the number of sequence numbers reserved for each frame
+         */
+        uint16_t GetStride(void) const;
+
+        /**
+         * @param frames the number of frames of the stream
+         */
+        void SetFrameCount(uint32_t frames);
+        /**
+         * @return the number of frames of the stream
+         */
+        uint32_t GetFrameCount(void) const;
+
+        virtual TypeId GetInstanceTypeId(void) const;
+        virtual void Print(std::ostream &os) const;
+        virtual uint32_t GetSerializedSize(void) const;
+        virtual void Serialize(Buffer::Iterator start) const;
+        virtual uint32_t Deserialize(Buffer::Iterator start);
+
+    private:
+        uint16_t m_stride; //!< Sequence numbers per frame
+        uint32_t m_frames; //!< Frames of the stream
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_INFO_HEADER_H */
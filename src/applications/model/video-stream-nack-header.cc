@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-stream-nack-header.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamNackHeader");
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamNackHeader);
+
+    TypeId
+    VideoStreamNackHeader::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamNackHeader")
+                                .SetParent<Header>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<VideoStreamNackHeader>();
+        return tid;
+    }
+
+    VideoStreamNackHeader::VideoStreamNackHeader()
+        : m_baseSeqNum(0),
+          m_deadlineMs(NO_DEADLINE),
+          m_frameIntervalMs(0),
+          m_truncated(false)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    bool
+    VideoStreamNackHeader::AddSeqNum(uint32_t seqNum)
+    {
+        if (m_bitmap.empty())
+        {
+            m_baseSeqNum = seqNum;
+        }
+        if (seqNum < m_baseSeqNum)
+        {
+            return false;
+        }
+
+        uint32_t offset = seqNum - m_baseSeqNum;
+        uint32_t word = offset / 32;
+        if (word >= MAX_WORDS)
+        {
+            return false;
+        }
+        if (word >= m_bitmap.size())
+        {
+            m_bitmap.resize(word + 1, 0);
+        }
+        m_bitmap[word] |= (1u << (offset % 32));
+        return true;
+    }
+
+    uint32_t
+    VideoStreamNackHeader::GetBaseSeqNum(void) const
+    {
+        return m_baseSeqNum;
+    }
+
+    std::vector<uint32_t>
+    VideoStreamNackHeader::GetSeqNums(void) const
+    {
+        std::vector<uint32_t> seqNums;
+        for (uint32_t w = 0; w < m_bitmap.size(); w++)
+        {
+            uint32_t bits = m_bitmap[w];
+            for (uint32_t i = 0; bits != 0; i++, bits >>= 1)
+            {
+                if (bits & 1)
+                {
+                    seqNums.push_back(m_baseSeqNum + 32 * w + i);
+                }
+            }
+        }
+        return seqNums;
+    }
+
+    bool
+    VideoStreamNackHeader::IsEmpty(void) const
+    {
+        return m_bitmap.empty();
+    }
+
+    void
+    VideoStreamNackHeader::SetDeadline(Time deadline, Time frameInterval)
+    {
+        m_deadlineMs = std::min<int64_t>(std::max<int64_t>(deadline.GetMilliSeconds(), 0), NO_DEADLINE - 1);
+        m_frameIntervalMs = std::min<int64_t>(frameInterval.GetMilliSeconds(), 0xffff);
+    }
+
+    bool
+    VideoStreamNackHeader::HasDeadline(void) const
+    {
+        return m_deadlineMs != NO_DEADLINE;
+    }
+
+    Time
+    VideoStreamNackHeader::GetDeadline(void) const
+    {
+        return HasDeadline() ? MilliSeconds(m_deadlineMs) : Time::Max();
+    }
+
+    Time
+    VideoStreamNackHeader::GetFrameInterval(void) const
+    {
+        return MilliSeconds(m_frameIntervalMs);
+    }
+
+    TypeId
+    VideoStreamNackHeader::GetInstanceTypeId(void) const
+    {
+        return GetTypeId();
+    }
+
+    void
+    VideoStreamNackHeader::Print(std::ostream &os) const
+    {
+        os << "(base=" << m_baseSeqNum << " words=" << m_bitmap.size() << " deadline=" << m_deadlineMs << "ms)";
+    }
+
+    uint32_t
+    VideoStreamNackHeader::GetSerializedSize(void) const
+    {
+        return 4 + 2 + 2 + 2 + 2 + 4 * m_bitmap.size();
+    }
+
+    void
+    VideoStreamNackHeader::Serialize(Buffer::Iterator start) const
+    {
+        Buffer::Iterator i = start;
+        i.WriteHtonU32(m_baseSeqNum);
+        i.WriteHtonU16(m_bitmap.size());
+        i.WriteHtonU16(m_deadlineMs);
+        i.WriteHtonU16(m_frameIntervalMs);
+        i.WriteHtonU16(0);
+        for (uint32_t w = 0; w < m_bitmap.size(); w++)
+        {
+            i.WriteHtonU32(m_bitmap[w]);
+        }
+    }
+
+    uint32_t
+    VideoStreamNackHeader::Deserialize(Buffer::Iterator start)
+    {
+        Buffer::Iterator i = start;
+        m_baseSeqNum = i.ReadNtohU32();
+        uint16_t words = i.ReadNtohU16();
+        m_deadlineMs = i.ReadNtohU16();
+        m_frameIntervalMs = i.ReadNtohU16();
+        i.ReadNtohU16();
+        // 수신한 단어 수를 믿지 않고 MAX_WORDS와 남은 바이트 수로 제한한다
+        uint32_t present = std::min<uint32_t>(words, std::min<uint32_t>(MAX_WORDS, i.GetRemainingSize() / 4));
+        m_truncated = present < words;
+        m_bitmap.assign(present, 0);
+        for (uint32_t w = 0; w < present; w++)
+        {
+            m_bitmap[w] = i.ReadNtohU32();
+        }
+        return GetSerializedSize();
+    }
+
+    bool
+    VideoStreamNackHeader::IsTruncated(void) const
+    {
+        return m_truncated;
+    }
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_NACK_HEADER_H
+#define VIDEO_STREAM_NACK_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * @brief Coalesced retransmission request (NACK) of the video stream.
+     *
+     * A single NACK carries every missing sequence number of one feedback
+     * interval as a base sequence number followed by a bitmap: bit i of
+     * word w marks sequence number (base + 32 * w + i) as lost.
+     *
+     * The NACK also carries the playout deadline of the frame of the base
+     * sequence number, relative to the moment the NACK is sent, and the
+     * frame interval, so the deadline of any later frame can be derived.
+     *
+     * Layout: base seq (4 bytes) | number of words (2 bytes) | deadline in ms (2 bytes) |
+     *         frame interval in ms (2 bytes) | reserved (2 bytes) | bitmap words (4 bytes each)
+     *
+     * The NACK follows a VideoStreamControlHeader of type NACK.
+     */
+    class VideoStreamNackHeader : public Header
+    {
+    public:
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamNackHeader();
+
+        /**
+         * @brief Mark a sequence number as lost.
+         *
+         * The first added sequence number becomes the base. Sequence numbers
+         * must be added in increasing order.
+         *
+         * @param seqNum the lost sequence number
+         * @return false if seqNum is outside the range one NACK can cover
+         */
+        bool AddSeqNum(uint32_t seqNum);
+
+        /**
+         * @return the first lost sequence number
+         */
+        uint32_t GetBaseSeqNum(void) const;
+
+        /**
+         * @brief Expand the bitmap into the lost sequence numbers.
+         *
+         * @return lost sequence numbers in increasing order
+         */
+        std::vector<uint32_t> GetSeqNums(void) const;
+
+        /**
+         * @return true if no sequence number has been added
+         */
+        bool IsEmpty(void) const;
+
+        /**
+         * @brief Set the playout deadline of the frame of the base sequence number.
+         *
+         * @param deadline time left until the frame is played, relative to now
+         * @param frameInterval time between two played frames
+         */
+        void SetDeadline(Time deadline, Time frameInterval);
+
+        /**
+         * @return true if the NACK carries a deadline
+         */
+        bool HasDeadline(void) const;
+
+        /**
+         * @return time left until the frame of the base sequence number is played
+         */
+        Time GetDeadline(void) const;
+
+        /**
+         * @return time between two played frames
+         */
+        Time GetFrameInterval(void) const;
+
+        /**
+         * @brief Check whether Deserialize dropped bitmap words.
+         *
+         * @return true if the received NACK declared more than MAX_WORDS
+         * words, or more words than the packet held
+         */
+        bool IsTruncated(void) const;
+
+        virtual TypeId GetInstanceTypeId(void) const;
+        virtual void Print(std::ostream &os) const;
+        virtual uint32_t GetSerializedSize(void) const;
+        virtual void Serialize(Buffer::Iterator start) const;
+        virtual uint32_t Deserialize(Buffer::Iterator start);
+
+        static const uint16_t MAX_WORDS = 64; //!< Bitmap words per NACK (2048 sequence numbers)
+        static const uint16_t NO_DEADLINE = 0xffff; //!< Deadline value of a NACK without deadline
+
+    private:
+        uint32_t m_baseSeqNum;         //!< First lost sequence number
+        std::vector<uint32_t> m_bitmap; //!< Loss bitmap relative to m_baseSeqNum
+        uint16_t m_deadlineMs;         //!< Relative deadline of the base frame in ms
+        uint16_t m_frameIntervalMs;    //!< Frame interval in ms
+        bool m_truncated;              //!< Whether Deserialize read fewer words than declared
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_NACK_HEADER_H */
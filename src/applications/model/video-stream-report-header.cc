@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-stream-report-header.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamReportHeader");
+
+    NS_OBJECT_ENSURE_REGISTERED(VideoStreamReportHeader);
+
+    TypeId
+    VideoStreamReportHeader::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::VideoStreamReportHeader")
+                                .SetParent<Header>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<VideoStreamReportHeader>();
+        return tid;
+    }
+
+    VideoStreamReportHeader::VideoStreamReportHeader()
+        : m_bufferedFrames(0),
+          m_throughputKbps(0),
+          m_lossFraction(0),
+          m_echoUs(0)
+    {
+        NS_LOG_FUNCTION(this);
+    }
+
+    void
+    VideoStreamReportHeader::SetBufferedFrames(uint16_t frames)
+    {
+        m_bufferedFrames = frames;
+    }
+
+    uint16_t
+    VideoStreamReportHeader::GetBufferedFrames(void) const
+    {
+        return m_bufferedFrames;
+    }
+
+    void
+    VideoStreamReportHeader::SetThroughput(uint64_t throughput)
+    {
+        m_throughputKbps = std::min<uint64_t>(throughput / 1000, 0xffffffff);
+    }
+
+    uint64_t
+    VideoStreamReportHeader::GetThroughput(void) const
+    {
+        return static_cast<uint64_t>(m_throughputKbps) * 1000;
+    }
+
+    void
+    VideoStreamReportHeader::SetLossFraction(double lossFraction)
+    {
+        m_lossFraction = static_cast<uint16_t>(std::min(std::max(lossFraction, 0.0), 1.0) * 0xffff);
+    }
+
+    double
+    VideoStreamReportHeader::GetLossFraction(void) const
+    {
+        return m_lossFraction / 65535.0;
+    }
+
+    void
+    VideoStreamReportHeader::SetEchoTimestamp(Time timestamp)
+    {
+        // 0은 타임스탬프가 없음을 뜻하므로 피한다
+        m_echoUs = std::max<uint32_t>(static_cast<uint32_t>(timestamp.GetMicroSeconds()), 1);
+    }
+
+    bool
+    VideoStreamReportHeader::HasEchoTimestamp(void) const
+    {
+        return m_echoUs != 0;
+    }
+
+    Time
+    VideoStreamReportHeader::GetRtt(Time now) const
+    {
+        if (!HasEchoTimestamp())
+        {
+            return Time();
+        }
+        // 32비트 마이크로초는 약 71분마다 한 바퀴 돌므로 차이만 쓴다
+        return MicroSeconds(static_cast<uint32_t>(static_cast<uint32_t>(now.GetMicroSeconds()) - m_echoUs));
+    }
+
+    TypeId
+    VideoStreamReportHeader::GetInstanceTypeId(void) const
+    {
+        return GetTypeId();
+    }
+
+    void
+    VideoStreamReportHeader::Print(std::ostream &os) const
+    {
+        os << "(buffered=" << m_bufferedFrames << " throughput=" << m_throughputKbps << "kbps loss=" << GetLossFraction() << " echo=" << m_echoUs << "us)";
+    }
+
+    uint32_t
+    VideoStreamReportHeader::GetSerializedSize(void) const
+    {
+        return 12;
+    }
+
+    void
+    VideoStreamReportHeader::Serialize(Buffer::Iterator start) const
+    {
+        Buffer::Iterator i = start;
+        i.WriteHtonU16(m_bufferedFrames);
+        i.WriteHtonU16(m_lossFraction);
+        i.WriteHtonU32(m_throughputKbps);
+        i.WriteHtonU32(m_echoUs);
+    }
+
+    uint32_t
+    VideoStreamReportHeader::Deserialize(Buffer::Iterator start)
+    {
+        Buffer::Iterator i = start;
+        m_bufferedFrames = i.ReadNtohU16();
+        m_lossFraction = i.ReadNtohU16();
+        m_throughputKbps = i.ReadNtohU32();
+        m_echoUs = i.ReadNtohU32();
+        return GetSerializedSize();
+    }
+
+} // namespace ns3
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_REPORT_HEADER_H
+#define VIDEO_STREAM_REPORT_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+
+    /**
+     * @brief Periodic report of a video stream client.
+     *
+     * Layout: buffered frames (2 bytes) | loss fraction in 1/65535 (2 bytes) |
+     *         throughput in kbit/s (4 bytes) | echoed timestamp in us (4 bytes)
+     *
+     * The echoed timestamp is the send time of the last packet the client
+     * received plus the time the client held it, so the server gets the
+     * round trip time by subtracting it from the current time.
+     *
+     * The report follows a VideoStreamControlHeader of type REPORT.
+     */
+    class VideoStreamReportHeader : public Header
+    {
+    public:
+        /**
+         * @brief Get the type ID.
+         *
+         * @return the object TypeId
+         */
+        static TypeId GetTypeId(void);
+
+        VideoStreamReportHeader();
+
+        /**
+         * @param frames the number of frames in the client buffer
+         */
+        void SetBufferedFrames(uint16_t frames);
+        /**
+         * @return the number of frames in the client buffer
+         */
+        uint16_t GetBufferedFrames(void) const;
+
+        /**
+         * @param throughput the throughput measured by the client in bit/s
+         */
+        void SetThroughput(uint64_t throughput);
+        /**
+         * @return the throughput measured by the client in bit/s
+         */
+        uint64_t GetThroughput(void) const;
+
+        /**
+         * @param lossFraction fraction of the packets lost since the last report, in [0, 1]
+         */
+        void SetLossFraction(double lossFraction);
+        /**
+         * @return fraction of the packets lost since the last report
+         */
+        double GetLossFraction(void) const;
+
+        /**
+         * @param timestamp send time of the last received packet plus the time it was held
+         */
+        void SetEchoTimestamp(Time timestamp);
+        /**
+         * @return true if the report echoes a timestamp
+         */
+        bool HasEchoTimestamp(void) const;
+        /**
+         * @param now the current time
+         * @return the round trip time the echoed timestamp gives at now
+         */
+        Time GetRtt(Time now) const;
+
+        virtual TypeId GetInstanceTypeId(void) const;
+        virtual void Print(std::ostream &os) const;
+        virtual uint32_t GetSerializedSize(void) const;
+        virtual void Serialize(Buffer::Iterator start) const;
+        virtual uint32_t Deserialize(Buffer::Iterator start);
+
+    private:
+        uint16_t m_bufferedFrames; //!< Frames in the client buffer
+        uint32_t m_throughputKbps; //!< Measured throughput in kbit/s
+        uint16_t m_lossFraction;   //!< Loss fraction scaled to 65535
+        uint32_t m_echoUs;         //!< Echoed timestamp in us modulo 2^32, 0 if none
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_REPORT_HEADER_H */
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "video-stream-rtt-estimator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamRttEstimator");
+
+    VideoStreamRttEstimator::VideoStreamRttEstimator()
+        : m_hasSample(false),
+          m_initialRto(MilliSeconds(200)),
+          m_minRto(MilliSeconds(10)),
+          m_maxRto(Seconds(1)),
+          m_granularity(MilliSeconds(1))
+    {
+    }
+
+    void
+    VideoStreamRttEstimator::Setup(Time initialRto, Time minRto, Time maxRto, Time granularity)
+    {
+        NS_LOG_FUNCTION(this << initialRto << minRto << maxRto << granularity);
+        m_initialRto = initialRto;
+        m_minRto = minRto;
+        m_maxRto = std::max(minRto, maxRto);
+        m_granularity = granularity;
+    }
+
+    void
+    VideoStreamRttEstimator::Update(Time sample)
+    {
+        if (!m_hasSample)
+        {
+            m_hasSample = true;
+            m_srtt = sample;
+            m_rttVar = sample / 2;
+            return;
+        }
+        // alpha = 1/8, beta = 1/4
+        Time delta = m_srtt > sample ? m_srtt - sample : sample - m_srtt;
+        m_rttVar = (m_rttVar * static_cast<int64_t>(3) + delta) / 4;
+        m_srtt = (m_srtt * static_cast<int64_t>(7) + sample) / 8;
+    }
+
+    bool
+    VideoStreamRttEstimator::HasSample(void) const
+    {
+        return m_hasSample;
+    }
+
+    Time
+    VideoStreamRttEstimator::GetSrtt(void) const
+    {
+        return m_srtt;
+    }
+
+    Time
+    VideoStreamRttEstimator::GetRttVar(void) const
+    {
+        return m_rttVar;
+    }
+
+    Time
+    VideoStreamRttEstimator::GetRto(void) const
+    {
+        Time rto = m_hasSample ? m_srtt + std::max(m_granularity, m_rttVar * static_cast<int64_t>(4)) : m_initialRto;
+        return std::min(std::max(rto, m_minRto), m_maxRto);
+    }
+
+} // namespace ns3
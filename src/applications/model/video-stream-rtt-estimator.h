@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_RTT_ESTIMATOR_H
+#define VIDEO_STREAM_RTT_ESTIMATOR_H
+
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+
+    /**
+     * @brief Smoothed round trip time and its variation (RFC 6298).
+     *
+     * The server feeds it the echoed timestamps of the client reports, the
+     * client the time between a NACK and the first arrival of a packet it
+     * requested once. The retransmission timeout is
+     * SRTT + max(G, 4 * RTTVAR), bounded by a minimum and a maximum.
+     */
+    class VideoStreamRttEstimator
+    {
+    public:
+        VideoStreamRttEstimator();
+
+        /**
+         * @brief Configure the timeout.
+         *
+         * @param initialRto the timeout before the first sample
+         * @param minRto the smallest timeout
+         * @param maxRto the largest timeout
+         * @param granularity the clock granularity G
+         */
+        void Setup(Time initialRto, Time minRto, Time maxRto, Time granularity);
+
+        /**
+         * @brief Add a round trip time measurement.
+         *
+         * @param sample the measured round trip time
+         */
+        void Update(Time sample);
+
+        /**
+         * @return true if at least one sample was added
+         */
+        bool HasSample(void) const;
+
+        /**
+         * @return the smoothed round trip time, zero before the first sample
+         */
+        Time GetSrtt(void) const;
+
+        /**
+         * @return the round trip time variation, zero before the first sample
+         */
+        Time GetRttVar(void) const;
+
+        /**
+         * @return the retransmission timeout
+         */
+        Time GetRto(void) const;
+
+    private:
+        bool m_hasSample;
+        Time m_srtt;
+        Time m_rttVar;
+        Time m_initialRto;
+        Time m_minRto;
+        Time m_maxRto;
+        Time m_granularity;
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_RTT_ESTIMATOR_H */
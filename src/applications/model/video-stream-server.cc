@@ -13,10 +13,23 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
-//#include "ns3/trace-source-accessor.h"
-#include "seq-ts-header.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/data-rate.h"
+#include "ns3/double.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/string.h"
+#include "ns3/object-factory.h"
+#include "video-stream-nack-header.h"
+#include "video-stream-report-header.h"
+#include "video-stream-control-header.h"
+#include "video-stream-frame-header.h"
+#include "video-stream-info-header.h"
 #include "ns3/video-stream-server.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace ns3
 {
 
@@ -35,6 +48,12 @@ namespace ns3
                                               TimeValue(Seconds(0.01)),
                                               MakeTimeAccessor(&VideoStreamServer::m_interval),
                                               MakeTimeChecker())
+                                .AddAttribute("SendScheduling", "How the frames of the clients are scheduled: one event per client and frame, "
+                                              "or one tick per interval that sends the frames of all due clients",
+                                              EnumValue(VideoStreamServer::SEND_BATCHED),
+                                              MakeEnumAccessor(&VideoStreamServer::m_sendScheduling),
+                                              MakeEnumChecker(VideoStreamServer::SEND_PER_CLIENT, "PerClient",
+                                                              VideoStreamServer::SEND_BATCHED, "Batched"))
                                 .AddAttribute("Port", "Port on which we listen for incoming packets.",
                                               UintegerValue(5000),
                                               MakeUintegerAccessor(&VideoStreamServer::m_port),
@@ -46,7 +65,180 @@ namespace ns3
                                 .AddAttribute("PacketNum", "The number of packet in each frame",
                                               UintegerValue(100),
                                               MakeUintegerAccessor(&VideoStreamServer::m_packetNum),
-                                              MakeUintegerChecker<uint16_t>());
+                                              MakeUintegerChecker<uint16_t>())
+                                .AddAttribute("VideoTraceFile", "Trace of the encoded video, one '<I|P|B> <bytes>' line per frame. "
+                                              "Empty sends PacketNum packets per frame for 60 seconds.",
+                                              StringValue(""),
+                                              MakeStringAccessor(&VideoStreamServer::m_traceFile),
+                                              MakeStringChecker())
+                                .AddAttribute("TraceChunkFrames", "The number of frames of the video trace read from the file at once",
+                                              UintegerValue(1024),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_traceChunkFrames),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddAttribute("TraceCacheChunks", "The smallest number of trace chunks kept in memory; "
+                                              "the cache grows to two chunks per active client",
+                                              UintegerValue(4),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_traceCacheChunks),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddAttribute("FramePriority", "Whether packets of I frames are sent and retransmitted before those of P frames, "
+                                              "and those of P frames before those of B frames",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&VideoStreamServer::m_framePriority),
+                                              MakeBooleanChecker())
+                                .AddAttribute("DropBacklog", "The number of packets waiting to be sent to a client above which "
+                                              "B frames and their retransmissions are dropped, 0 to never drop. Needs pacing.",
+                                              UintegerValue(0),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_dropBacklog),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("ClientTimeout", "The time without any packet from a unicast client after which its stream "
+                                              "is stopped and its state freed, 0 to wait for its bye",
+                                              TimeValue(Seconds(3)),
+                                              MakeTimeAccessor(&VideoStreamServer::m_clientTimeout),
+                                              MakeTimeChecker(Seconds(0)))
+                                .AddAttribute("FastStartFrames", "The number of initial frames of a unicast client sent faster than "
+                                              "the frame interval, 0 to disable fast start",
+                                              UintegerValue(0),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_fastStartFrames),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("FastStartSpeedup", "How many times faster than the frame interval frames are sent during fast start",
+                                              DoubleValue(4.0),
+                                              MakeDoubleAccessor(&VideoStreamServer::m_fastStartSpeedup),
+                                              MakeDoubleChecker<double>(1.0))
+                                .AddAttribute("FastStartMaxRate", "The largest video rate of a client during fast start, 0 for no bound. "
+                                              "The congestion controlled rate bounds it as well.",
+                                              DataRateValue(DataRate(0)),
+                                              MakeDataRateAccessor(&VideoStreamServer::m_fastStartMaxRate),
+                                              MakeDataRateChecker())
+                                .AddAttribute("FastStartPrimedFrames", "Buffered frames reported by a client that end its fast start early, "
+                                              "0 to always send FastStartFrames frames fast",
+                                              UintegerValue(0),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_fastStartPrimed),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("PayloadMode", "How the payload of the packets is built",
+                                              EnumValue(VideoFramePayloadStore::PAYLOAD_STAMPED),
+                                              MakeEnumAccessor(&VideoStreamServer::m_payloadMode),
+                                              MakeEnumChecker(VideoFramePayloadStore::PAYLOAD_COPY, "Copy",
+                                                              VideoFramePayloadStore::PAYLOAD_STAMPED, "Stamped",
+                                                              VideoFramePayloadStore::PAYLOAD_VIRTUAL, "Virtual"))
+                                .AddAttribute("PayloadCacheFrames", "The number of frame payloads shared between clients and retransmissions",
+                                              UintegerValue(64),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_payloadCacheFrames),
+                                              MakeUintegerChecker<uint32_t>(1, 65535))
+                                .AddAttribute("PacingMode", "How the packets of a frame are spread over the interval",
+                                              EnumValue(VideoStreamServer::PACING_RATE),
+                                              MakeEnumAccessor(&VideoStreamServer::m_pacingMode),
+                                              MakeEnumChecker(VideoStreamServer::PACING_NONE, "None",
+                                                              VideoStreamServer::PACING_RATE, "Rate",
+                                                              VideoStreamServer::PACING_TOKEN_BUCKET, "TokenBucket"))
+                                .AddAttribute("PacingRate", "The rate packets are paced at. 0 uses 1.25 times the video bitrate, "
+                                              "which spreads a frame over 80% of the interval and leaves room for retransmissions.",
+                                              DataRateValue(DataRate(0)),
+                                              MakeDataRateAccessor(&VideoStreamServer::m_pacingRate),
+                                              MakeDataRateChecker())
+                                .AddAttribute("PacingBurst", "The token bucket depth in bytes",
+                                              UintegerValue(10 * 1400),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_pacingBurst),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("AbrAlgorithm", "How the video level of each client is selected from its reports",
+                                              EnumValue(VideoStreamAbr::ABR_NONE),
+                                              MakeEnumAccessor(&VideoStreamServer::m_abrAlgorithm),
+                                              MakeEnumChecker(VideoStreamAbr::ABR_NONE, "None",
+                                                              VideoStreamAbr::ABR_BUFFER, "BufferBased",
+                                                              VideoStreamAbr::ABR_THROUGHPUT, "ThroughputBased"))
+                                .AddAttribute("AbrReservoir", "Buffered frames below which the lowest video level is used",
+                                              UintegerValue(20),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_abrReservoir),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("AbrCushion", "Buffered frames above the reservoir at which the highest video level is reached",
+                                              UintegerValue(60),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_abrCushion),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("AbrSafety", "Fraction of the reported throughput the video may use",
+                                              DoubleValue(0.8),
+                                              MakeDoubleAccessor(&VideoStreamServer::m_abrSafety),
+                                              MakeDoubleChecker<double>(0.0, 1.0))
+                                .AddAttribute("InitialVideoLevel", "The video level a new client starts at when ABR is enabled",
+                                              UintegerValue(3),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_initialVideoLevel),
+                                              MakeUintegerChecker<uint32_t>(1, MAX_VIDEO_LEVEL))
+                                .AddAttribute("CongestionControl", "Type name of the congestion controller of each client "
+                                              "(e.g. ns3::VideoStreamTfrc, ns3::VideoStreamDelayBased), empty to disable",
+                                              StringValue(""),
+                                              MakeStringAccessor(&VideoStreamServer::m_ccType),
+                                              MakeStringChecker())
+                                .AddAttribute("FecMode", "The forward error correction code of the stream",
+                                              EnumValue(VideoStreamFec::FEC_NONE),
+                                              MakeEnumAccessor(&VideoStreamServer::m_fecMode),
+                                              MakeEnumChecker(VideoStreamFec::FEC_NONE, "None",
+                                                              VideoStreamFec::FEC_XOR, "Xor",
+                                                              VideoStreamFec::FEC_REED_SOLOMON, "ReedSolomon"))
+                                .AddAttribute("FecBlockSize", "Source packets protected by each group of parity packets, 0 for the whole frame",
+                                              UintegerValue(0),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_fecBlockSize),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("FecParity", "Parity packets per block with Reed-Solomon",
+                                              UintegerValue(2),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_fecParity),
+                                              MakeUintegerChecker<uint32_t>(1, 255))
+                                .AddAttribute("MulticastGroup", "Send every frame once to this group instead of once per client. "
+                                              "Any non-multicast address keeps one unicast stream per client.",
+                                              Ipv4AddressValue(Ipv4Address::GetAny()),
+                                              MakeIpv4AddressAccessor(&VideoStreamServer::m_multicastGroup),
+                                              MakeIpv4AddressChecker())
+                                .AddAttribute("MulticastPort", "The port the receivers of the group listen on",
+                                              UintegerValue(5001),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_multicastPort),
+                                              MakeUintegerChecker<uint16_t>())
+                                .AddAttribute("NackAggregation", "The interval NACKs of the group are merged over before retransmitting",
+                                              TimeValue(MilliSeconds(2)),
+                                              MakeTimeAccessor(&VideoStreamServer::m_nackAggregation),
+                                              MakeTimeChecker())
+                                .AddAttribute("MulticastRetransThreshold", "Receivers that must lose a packet for it to be retransmitted to the whole group",
+                                              UintegerValue(2),
+                                              MakeUintegerAccessor(&VideoStreamServer::m_multicastThreshold),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddTraceSource("ExpiredRetransmissions", "Number of requested retransmissions skipped because their frame was already played",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_expiredRetrans),
+                                                "ns3::TracedValueCallback::Uint64")
+                                .AddTraceSource("MulticastRetransmissions", "Number of retransmissions sent once to the whole group",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_multicastRetrans),
+                                                "ns3::TracedValueCallback::Uint64")
+                                .AddTraceSource("UnicastRetransmissions", "Number of retransmissions of the group sent to a single receiver",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_unicastRetrans),
+                                                "ns3::TracedValueCallback::Uint64")
+                                .AddTraceSource("DroppedFrames", "Number of frames dropped because the backlog of their client was too long",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_droppedFrames),
+                                                "ns3::TracedValueCallback::Uint64")
+                                .AddTraceSource("FrameDropped", "A frame is dropped because the backlog of its client is too long",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_frameDropTrace),
+                                                "ns3::VideoStreamServer::FrameCallback")
+                                .AddTraceSource("FastStartEnd", "A client leaves fast start, with the number of frames sent so far",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_fastStartEndTrace),
+                                                "ns3::VideoStreamServer::FrameCallback")
+                                .AddTraceSource("ActiveClients", "Number of streams the server keeps state for",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_activeClients),
+                                                "ns3::TracedValueCallback::Uint32")
+                                .AddTraceSource("ClientRemoved", "A client said bye or timed out and its stream was stopped",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_clientRemovedTrace),
+                                                "ns3::VideoStreamServer::ClientRemovedCallback")
+                                .AddTraceSource("Tx", "A packet of a video stream is sent",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_txTrace),
+                                                "ns3::Packet::AddressTracedCallback")
+                                .AddTraceSource("Rx", "A control packet is received",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_rxTrace),
+                                                "ns3::Packet::AddressTracedCallback")
+                                .AddTraceSource("RetransmissionSent", "A requested packet is sent again",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_retransSentTrace),
+                                                "ns3::VideoStreamServer::SeqNumCallback")
+                                .AddTraceSource("CongestionRate", "The congestion controlled rate of a client after each of its reports",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_ccRateTrace),
+                                                "ns3::VideoStreamServer::CongestionRateCallback")
+                                .AddTraceSource("CongestionWindow", "The congestion window of a client after each of its reports",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_cwndTrace),
+                                                "ns3::VideoStreamServer::CongestionWindowCallback")
+                                .AddTraceSource("Rtt", "The smoothed round trip time of a client after each of its reports",
+                                                MakeTraceSourceAccessor(&VideoStreamServer::m_rttTrace),
+                                                "ns3::VideoStreamServer::RttCallback");
         return tid;
     }
 
@@ -55,12 +247,15 @@ namespace ns3
         NS_LOG_FUNCTION(this);
         m_socket = 0;
 
-        m_nextSeqNum = 0;
-        m_waitingSeqNum = 0;
+        m_frameSize = 0;
+        m_maxFrameSize = 0;
         m_sendQueueSize = 32786;
-        m_sendQueue = new uint32_t[m_sendQueueSize]();
-        m_sendQueueFront = 0;
-        m_sendQueueBack = 0;
+        m_expiredRetrans = 0;
+        m_multicastRetrans = 0;
+        m_unicastRetrans = 0;
+        m_droppedFrames = 0;
+        m_activeClients = 0;
+        m_nextTick = Time::Max();
     }
 
     VideoStreamServer::~VideoStreamServer()
@@ -73,6 +268,13 @@ namespace ns3
     VideoStreamServer::DoDispose(void)
     {
         NS_LOG_FUNCTION(this);
+        m_clients.clear();
+        m_clientTable.clear();
+        m_nextSend.clear();
+        m_sendQueue = SendQueue();
+        m_freeSlots.clear();
+        m_pendingNacks.clear();
+        m_payloadStore.Clear();
         Application::DoDispose();
     }
 
@@ -81,6 +283,34 @@ namespace ns3
     {
         NS_LOG_FUNCTION(this);
 
+        if (!m_traceFile.empty())
+        {
+            m_trace.Open(m_traceFile, m_traceChunkFrames, m_traceCacheChunks);
+            m_frameSize = std::ceil(m_trace.GetMeanFrameSize());
+            m_maxFrameSize = m_trace.GetMaxFrameSize();
+            NS_ABORT_MSG_IF(m_trace.GetFrameCount() > 0xffffff, "Video traces of more than 2^24 frames are not supported");
+        }
+        else
+        {
+            m_frameSize = m_maxPacketSize * (m_packetNum - 1) + std::min<uint32_t>(1000, m_maxPacketSize);
+            m_maxFrameSize = m_frameSize;
+        }
+        NS_ABORT_MSG_IF(GetPacketsPerFrame() > 0xffff, "Frames of more than 65535 packets are not supported");
+        // 데이터 seq는 최상위 비트를 패리티 표시로 남겨 두어야 한다
+        NS_ABORT_MSG_IF(static_cast<uint64_t>(GetFrameCount()) * GetPacketsPerFrame() >= VideoStreamFec::PARITY_SEQ_FLAG,
+                        "Streams of 2^31 or more sequence numbers (frames times packets of the largest frame) are not supported");
+        m_payloadStore.Setup(m_payloadMode, m_maxPacketSize, m_payloadCacheFrames);
+        m_abr.Setup(m_abrAlgorithm, m_abrReservoir, m_abrCushion, m_abrSafety);
+        m_fec.Setup(m_fecMode, GetPacketsPerFrame(), m_fecBlockSize, m_fecParity);
+        if (m_fec.IsEnabled())
+        {
+            // 패리티 seq는 프레임 번호 23비트와 패리티 번호 8비트로 이루어진다
+            NS_ABORT_MSG_IF(GetFrameCount() >= VideoStreamFec::MAX_PARITY_FRAMES, "Streams of 2^23 or more frames are not supported with FEC");
+            NS_ABORT_MSG_IF(m_fec.GetBlocksPerFrame(GetPacketsPerFrame()) * m_fec.GetParityPerBlock() > VideoStreamFec::MAX_PARITY_PER_FRAME,
+                            "More than 256 parity packets per frame are not supported");
+        }
+        m_tickStart = Simulator::Now();
+
         if (m_socket == 0)
         {
             TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
@@ -122,57 +352,292 @@ namespace ns3
 
         for (auto iter = m_clients.begin(); iter != m_clients.end(); iter++)
         {
-            Simulator::Cancel(iter->second->m_sendEvent);
+            ClientInfo &client = m_clientTable[iter->second];
+            Simulator::Cancel(client.m_sendEvent);
+            Simulator::Cancel(client.m_pacingEvent);
+            Simulator::Cancel(client.m_livenessEvent);
         }
+        Simulator::Cancel(m_tickEvent);
+        m_nextTick = Time::Max();
+        m_sendQueue = SendQueue();
+        Simulator::Cancel(m_flushEvent);
     }
 
     // Send Frame
     void
-    VideoStreamServer::Send(uint32_t ipAddress)
+    VideoStreamServer::Send(uint32_t slot)
     {
-        NS_LOG_FUNCTION(this);
+        NS_LOG_FUNCTION(this << slot);
 
-        uint32_t frameSize = 1400 * (m_packetNum - 1) + 1000;
-        uint32_t totalFrames = 60 * 25;
-        ClientInfo *clientInfo = m_clients.at(ipAddress);
+        uint32_t totalFrames = GetFrameCount();
+        ClientInfo *clientInfo = &m_clientTable[slot];
+        uint32_t frameSize = GetFrame(clientInfo->m_sent).m_size;
 
         NS_ASSERT(clientInfo->m_sendEvent.IsExpired());
-        uint32_t remainder = frameSize % m_maxPacketSize;
+        // 프레임마다 최대 프레임 크기만큼 seq를 예약하고 앞에서부터 필요한 만큼만 쓴다
+        clientInfo->m_frameEnd = clientInfo->m_sent * GetPacketsPerFrame() + GetFramePackets(frameSize);
+        clientInfo->m_frameLevels[clientInfo->m_sent % FRAME_LEVEL_HISTORY] = clientInfo->m_videoLevel;
+        clientInfo->m_frameDropped[clientInfo->m_sent % FRAME_LEVEL_HISTORY] = false;
 
-        while (m_nextSeqNum < (clientInfo->m_sent + 1) * (frameSize / m_maxPacketSize) + 1)
+        if (m_pacingMode == PACING_NONE)
         {
-            SendPacket(clientInfo, m_maxPacketSize);
-
-            if (m_nextSeqNum == (clientInfo->m_sent + 1) * (frameSize / m_maxPacketSize))
+            // 재전송 요청된 패킷을 먼저 보내고, 이번 프레임의 마지막 패킷과 패리티까지 전송
+            while (clientInfo->m_nextSeqNum < clientInfo->m_frameEnd || !clientInfo->m_parityQueue.empty())
             {
-                SendPacket(clientInfo, remainder);
+                uint32_t seqNum = GetSeqNum(clientInfo);
+                SendPacket(clientInfo, seqNum);
             }
         }
+        else if (!clientInfo->m_pacingEvent.IsRunning())
+        {
+            SendPaced(slot);
+        }
 
-        NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server sent frame " << clientInfo->m_sent << " and " << frameSize << " bytes to " << InetSocketAddress::ConvertFrom(clientInfo->m_address).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(clientInfo->m_address).GetPort());
+        NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server sent frame " << clientInfo->m_sent << " and " << GetFrameSize(frameSize, clientInfo->m_videoLevel) << " bytes to " << InetSocketAddress::ConvertFrom(clientInfo->m_address).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(clientInfo->m_address).GetPort());
 
         clientInfo->m_sent += 1; // ���� ������ ���� ����
+        if (clientInfo->m_fastStart && clientInfo->m_sent >= m_fastStartFrames)
+        {
+            EndFastStart(clientInfo);
+        }
         if (clientInfo->m_sent < totalFrames)
         {
-            clientInfo->m_sendEvent = Simulator::Schedule(m_interval, &VideoStreamServer::Send, this, ipAddress);
+            // 빠른 시작 중에는 프레임 간격을 줄여 클라이언트 버퍼를 먼저 채운다
+            Time next = Simulator::Now() + m_interval;
+            if (clientInfo->m_fastStart)
+            {
+                next = Simulator::Now() + Seconds(m_interval.GetSeconds() / GetFastStartSpeedup(clientInfo));
+            }
+            else if (m_sendScheduling == SEND_BATCHED)
+            {
+                // 모든 클라이언트가 같은 틱에 보내도록 서버 시작 시각 기준의 간격 격자에 맞춘다
+                // 격자 밖에서 들어온 클라이언트가 두 프레임을 몰아 받지 않도록 한 간격 이상 뒤의 틱을 쓴다
+                next = GetTickTime(next);
+            }
+            ScheduleSend(slot, next);
+        }
+        else if (m_sendScheduling == SEND_BATCHED)
+        {
+            m_nextSend[slot] = Time::Max();
+        }
+    }
+
+    void
+    VideoStreamServer::SendTick(void)
+    {
+        NS_LOG_FUNCTION(this);
+
+        // 클라이언트 수만큼 이벤트를 만들지 않고, 틱 하나가 송신 시각 힙에서 때가 된 클라이언트만 꺼내 보낸다
+        Time now = Simulator::Now();
+        while (!m_sendQueue.empty() && m_sendQueue.top().first <= now)
+        {
+            std::pair<Time, uint32_t> due = m_sendQueue.top();
+            m_sendQueue.pop();
+            // 다시 잡혔거나 제거된 클라이언트의 항목은 m_nextSend와 달라 건너뛴다
+            if (m_nextSend[due.second] == due.first)
+            {
+                Send(due.second);
+            }
+        }
+        while (!m_sendQueue.empty() && m_nextSend[m_sendQueue.top().second] != m_sendQueue.top().first)
+        {
+            m_sendQueue.pop();
+        }
+
+        Time next = m_sendQueue.empty() ? Time::Max() : m_sendQueue.top().first;
+        m_nextTick = next;
+        if (next != Time::Max())
+        {
+            m_tickEvent = Simulator::Schedule(next - now, &VideoStreamServer::SendTick, this);
+        }
+    }
+
+    void
+    VideoStreamServer::ScheduleSend(uint32_t slot, Time when)
+    {
+        if (m_sendScheduling == SEND_PER_CLIENT)
+        {
+            m_clientTable[slot].m_sendEvent = Simulator::Schedule(when - Simulator::Now(), &VideoStreamServer::Send, this, slot);
+            return;
+        }
+
+        m_nextSend[slot] = when;
+        m_sendQueue.push(std::make_pair(when, slot));
+        // 틱 안에서는 m_nextTick이 현재 시각이므로 다시 잡지 않고, 틱이 끝날 때 한 번만 잡는다
+        if (when < m_nextTick)
+        {
+            Simulator::Cancel(m_tickEvent);
+            m_nextTick = when;
+            m_tickEvent = Simulator::Schedule(when - Simulator::Now(), &VideoStreamServer::SendTick, this);
+        }
+    }
+
+    Time
+    VideoStreamServer::GetTickTime(Time earliest) const
+    {
+        int64_t interval = m_interval.GetTimeStep();
+        int64_t elapsed = (earliest - m_tickStart).GetTimeStep();
+        return m_tickStart + TimeStep((elapsed + interval - 1) / interval * interval);
+    }
+
+    void
+    VideoStreamServer::SendPaced(uint32_t slot)
+    {
+        NS_LOG_FUNCTION(this << slot);
+
+        ClientInfo *clientInfo = &m_clientTable[slot];
+        DataRate rate = GetPacingRate(clientInfo);
+
+        if (m_pacingMode == PACING_TOKEN_BUCKET)
+        {
+            Time now = Simulator::Now();
+            clientInfo->m_tokens = std::min<double>(m_pacingBurst, clientInfo->m_tokens + rate.GetBitRate() * (now - clientInfo->m_lastRefill).GetSeconds() / 8);
+            clientInfo->m_lastRefill = now;
+        }
+
+        while (HasPendingPacket(clientInfo))
+        {
+            uint32_t packetSize = GetPacketSize(clientInfo, PeekSeqNum(clientInfo));
+            double needed = std::min(packetSize, m_pacingBurst);
+            if (m_pacingMode == PACING_TOKEN_BUCKET && clientInfo->m_tokens < needed)
+            {
+                // 다음 패킷을 보낼 만큼 토큰이 찰 때까지 대기
+                Time wait = rate.CalculateBytesTxTime(std::ceil(needed - clientInfo->m_tokens));
+                clientInfo->m_pacingEvent = Simulator::Schedule(wait, &VideoStreamServer::SendPaced, this, slot);
+                return;
+            }
+
+            uint32_t seqNum = GetSeqNum(clientInfo);
+            SendPacket(clientInfo, seqNum);
+
+            if (m_pacingMode == PACING_RATE)
+            {
+                clientInfo->m_pacingEvent = Simulator::Schedule(rate.CalculateBytesTxTime(packetSize), &VideoStreamServer::SendPaced, this, slot);
+                return;
+            }
+            clientInfo->m_tokens -= packetSize;
+        }
+    }
+
+    DataRate
+    VideoStreamServer::GetPacingRate(ClientInfo *client) const
+    {
+        uint64_t rate = m_pacingRate.GetBitRate();
+        if (rate == 0)
+        {
+            rate = static_cast<uint64_t>(1.25 * GetLevelBitrate(client->m_videoLevel));
+        }
+        if (client->m_fastStart)
+        {
+            rate = static_cast<uint64_t>(rate * GetFastStartSpeedup(client));
+        }
+        if (client->m_cc)
+        {
+            rate = std::min(rate, client->m_cc->GetRate().GetBitRate());
+        }
+        return DataRate(rate);
+    }
+
+    double
+    VideoStreamServer::GetFastStartSpeedup(ClientInfo *client) const
+    {
+        // 빠른 시작 속도는 FastStartMaxRate와 혼잡 제어 속도를 넘지 않고, 재생 속도보다 느려지지도 않는다
+        double speedup = m_fastStartSpeedup;
+        double bitrate = GetLevelBitrate(client->m_videoLevel);
+        if (m_fastStartMaxRate.GetBitRate() > 0)
+        {
+            speedup = std::min(speedup, m_fastStartMaxRate.GetBitRate() / bitrate);
+        }
+        if (client->m_cc)
+        {
+            speedup = std::min(speedup, client->m_cc->GetRate().GetBitRate() / bitrate);
+        }
+        return std::max(speedup, 1.0);
+    }
+
+    void
+    VideoStreamServer::EndFastStart(ClientInfo *client)
+    {
+        NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server ended fast start of " << InetSocketAddress::ConvertFrom(client->m_address).GetIpv4() << " after " << client->m_sent << " frames");
+        client->m_fastStart = false;
+        m_fastStartEndTrace(client->m_sent, client->m_address);
+    }
+
+    void
+    VideoStreamServer::HandleReport(ClientInfo *client, const VideoStreamReportHeader &report)
+    {
+        NS_LOG_FUNCTION(this << report);
+
+        if (client->m_fastStart && m_fastStartPrimed > 0 && report.GetBufferedFrames() >= m_fastStartPrimed)
+        {
+            EndFastStart(client);
+        }
+
+        Time rtt = report.GetRtt(Simulator::Now());
+        if (rtt.IsStrictlyPositive())
+        {
+            client->m_rtt.Update(rtt);
+            m_rttTrace(client->m_address, client->m_rtt.GetSrtt(), client->m_rtt.GetRttVar());
+        }
+
+        uint32_t level = MAX_VIDEO_LEVEL;
+        if (m_abr.GetAlgorithm() != VideoStreamAbr::ABR_NONE)
+        {
+            level = m_abr.SelectLevel(client->m_videoLevel, report.GetBufferedFrames(), report.GetThroughput(), GetLevelBitrate(MAX_VIDEO_LEVEL));
+        }
+        if (client->m_cc)
+        {
+            client->m_cc->OnReport(report.GetLossFraction(), rtt, DataRate(report.GetThroughput()));
+            uint64_t rate = client->m_cc->GetRate().GetBitRate();
+            m_ccRateTrace(client->m_address, rate);
+            m_cwndTrace(client->m_address, client->m_cc->GetCongestionWindow());
+            // 혼잡 제어가 허용하는 속도를 넘지 않는 레벨까지 낮춘다
+            while (level > 1 && GetLevelBitrate(level) > rate)
+            {
+                level--;
+            }
+        }
+        if (level != client->m_videoLevel)
+        {
+            NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server switched " << InetSocketAddress::ConvertFrom(client->m_address).GetIpv4() << " from level " << client->m_videoLevel << " to " << level);
+            client->m_videoLevel = level;
         }
     }
 
     void
-    VideoStreamServer::SendPacket(ClientInfo *client, uint32_t packetSize)
-    {
-        uint8_t dataBuffer[packetSize];
-        sprintf((char *)dataBuffer, "%u", client->m_sent);
-        Ptr<Packet> p = Create<Packet>(dataBuffer, packetSize);
-        uint32_t seqNum = GetSeqNum();
-        SeqTsHeader seqTs;
-        seqTs.SetSeq(seqNum);
-        p->AddHeader(seqTs);
-        // m_txTrace(p);
+    VideoStreamServer::SendPacket(ClientInfo *client, uint32_t seqNum)
+    {
+        SendPacket(client, seqNum, client->m_address);
+    }
+
+    void
+    VideoStreamServer::SendPacket(ClientInfo *client, uint32_t seqNum, const Address &to)
+    {
+        uint32_t packetsPerFrame = GetPacketsPerFrame();
+        bool parity = VideoStreamFec::IsParitySeqNum(seqNum);
+        uint32_t frameNum = parity ? VideoStreamFec::GetParityFrame(seqNum) : seqNum / packetsPerFrame;
+        uint32_t level = client->m_frameLevels[frameNum % FRAME_LEVEL_HISTORY];
+        VideoFrameTrace::Frame frame = GetFrame(frameNum);
+        uint32_t packetSize = GetPacketSize(client, seqNum);
+        // 페이로드 내용은 의미가 없으므로 패리티 패킷은 프레임 앞부분을 그대로 쓴다
+        // 레벨마다 크기가 다르므로 공유 페이로드는 항상 최고 레벨 크기로 만든다
+        uint32_t index = parity ? VideoStreamFec::GetParityIndex(seqNum) : seqNum - frameNum * packetsPerFrame;
+        uint32_t offset = parity ? 0 : index * GetLevelPacketSize(frame.m_size, level, false);
+        Ptr<Packet> p = m_payloadStore.GetPacket(frameNum, frame.m_size, offset, packetSize);
+        VideoStreamFrameHeader frameHeader;
+        frameHeader.SetFrameNum(frameNum);
+        frameHeader.SetPacketIndex(index);
+        frameHeader.SetParity(parity);
+        frameHeader.SetTimestamp(Simulator::Now());
+        frameHeader.SetFramePackets(GetFramePackets(frame.m_size));
+        frameHeader.SetFrameType(frame.m_type);
+        frameHeader.SetRefDistance(frame.m_refDistance);
+        p->AddHeader(frameHeader);
+        m_txTrace(p, to);
         NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server sent packet # " << seqNum);
-        if (m_socket->SendTo(p, 0, client->m_address) < 0)
+        if (m_socket->SendTo(p, 0, to) < 0)
         {
-            NS_LOG_INFO("Error while sending " << packetSize << "bytes to " << InetSocketAddress::ConvertFrom(client->m_address).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(client->m_address).GetPort());
+            NS_LOG_INFO("Error while sending " << packetSize << "bytes to " << InetSocketAddress::ConvertFrom(to).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(to).GetPort());
         }
     }
 
@@ -184,81 +649,596 @@ namespace ns3
         Ptr<Packet> packet;
         Address from;
         Address localAddress;
-        SeqTsHeader seqTs;
-        uint32_t seqNum;
         while ((packet = socket->RecvFrom(from)))
         {
             socket->GetSockName(localAddress);
-            if (packet->GetSize() > 10)
+            m_rxTrace(packet, from);
+            VideoStreamControlHeader control;
+            if (!InetSocketAddress::IsMatchingType(from) || packet->GetSize() < control.GetSerializedSize())
             {
-                packet->RemoveHeader(seqTs);
-                seqNum = seqTs.GetSeq();
+                continue;
             }
-            if (InetSocketAddress::IsMatchingType(from))
-            {
-                NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server received " << packet->GetSize() << " bytes from " << InetSocketAddress::ConvertFrom(from).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(from).GetPort() << " seq " << seqNum);
+            packet->RemoveHeader(control);
+            VideoStreamControlHeader::MessageType type = control.GetMessageType();
+            NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server received " << control << " from " << InetSocketAddress::ConvertFrom(from).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(from).GetPort());
 
-                uint32_t ipAddr = InetSocketAddress::ConvertFrom(from).GetIpv4().Get();
+            if (m_multicastGroup.IsMulticast())
+            {
+                // 멀티캐스트 모드에서는 모든 수신자가 그룹 스트림 하나를 공유하므로 수신자별 세션이 없다
+                bool started = m_clients.find(GetGroupKey()) != m_clients.end();
+                if (type == VideoStreamControlHeader::HELLO)
+                {
+                    if (!started)
+                    {
+                        ClientInfo *group = AddClient(GetGroupKey(), InetSocketAddress(m_multicastGroup, m_multicastPort));
+                        // 수신자마다 상태가 다르므로 그룹 스트림은 가장 높은 레벨로 고정하고 혼잡 제어도 하지 않는다
+                        group->m_videoLevel = MAX_VIDEO_LEVEL;
+                        group->m_cc = 0;
+                        group->m_fastStart = false;
+                        Simulator::Cancel(group->m_livenessEvent);
+                    }
+                    SendStreamInfo(from);
+                }
+                else if (type == VideoStreamControlHeader::NACK && started)
+                {
+                    VideoStreamNackHeader nack;
+                    if (!RemoveNack(packet, nack, from))
+                    {
+                        continue;
+                    }
+                    if (!nack.IsEmpty())
+                    {
+                        AggregateNack(from, nack);
+                    }
+                }
+                continue;
+            }
 
-                // the first time we received the message from the client
-                if (m_clients.find(ipAddr) == m_clients.end())
+            uint64_t key = GetClientKey(from);
+            auto iter = m_clients.find(key);
+            if (iter == m_clients.end())
+            {
+                // 스트림은 HELLO로만 시작하므로 떠난 클라이언트의 늦은 패킷이 스트림을 되살리지 않는다
+                if (type == VideoStreamControlHeader::HELLO)
+                {
+                    // 첫 프레임보다 먼저 도착하도록 송신 이벤트가 돌기 전에 보낸다
+                    AddClient(key, from);
+                    SendStreamInfo(from);
+                }
+                continue;
+            }
+            uint32_t slot = iter->second;
+            ClientInfo *client = &m_clientTable[slot];
+            client->m_lastHeard = Simulator::Now();
+            switch (type)
+            {
+            case VideoStreamControlHeader::NACK:
+            {
+                VideoStreamNackHeader nack;
+                if (!RemoveNack(packet, nack, from))
                 {
-                    ClientInfo *newClient = new ClientInfo();
-                    newClient->m_sent = 0;
-                    // newClient->m_videoLevel = 3;
-                    newClient->m_address = from;
-                    // newClient->m_sendEvent = EventId ();
-                    m_clients[ipAddr] = newClient;
-                    newClient->m_sendEvent = Simulator::Schedule(Seconds(0.0), &VideoStreamServer::Send, this, ipAddr);
+                    break;
                 }
+                if (!nack.IsEmpty())
+                {
+                    AddAckSeqNum(client, nack);
+                    // 페이싱 중이면 다음 프레임을 기다리지 않고 재전송
+                    if (m_pacingMode != PACING_NONE && !client->m_pacingEvent.IsRunning())
+                    {
+                        SendPaced(slot);
+                    }
+                }
+                break;
             }
-            if (packet->GetSize() > 10)
+            case VideoStreamControlHeader::REPORT:
             {
-                AddAckSeqNum(seqNum);
-                socket->GetSockName(localAddress);
+                VideoStreamReportHeader report;
+                if (packet->GetSize() < report.GetSerializedSize())
+                {
+                    NS_LOG_WARN("Dropped a report of " << packet->GetSize() << " bytes from " << InetSocketAddress::ConvertFrom(from).GetIpv4());
+                    break;
+                }
+                packet->RemoveHeader(report);
+                HandleReport(client, report);
+                break;
+            }
+            case VideoStreamControlHeader::BYE:
+                RemoveClient(slot, false);
+                break;
+            case VideoStreamControlHeader::HELLO:
+                // 스트림 정보를 잃은 클라이언트가 HELLO를 다시 보낸다
+                SendStreamInfo(from);
+                break;
+            default:
+                // KEEPALIVE는 마지막 수신 시각만 갱신한다
+                break;
             }
-            // m_rxTrace(packet);
-            // m_rxTraceWithAddresses(packet, from, localAddress);
         }
     }
 
+    bool
+    VideoStreamServer::RemoveNack(Ptr<Packet> packet, VideoStreamNackHeader &nack, const Address &from)
+    {
+        // 빈 NACK의 크기가 고정 부분이고, 비트맵 단어 수는 Deserialize가 남은 바이트로 확인한다
+        if (packet->GetSize() < nack.GetSerializedSize())
+        {
+            NS_LOG_WARN("Dropped a NACK of " << packet->GetSize() << " bytes from " << InetSocketAddress::ConvertFrom(from).GetIpv4());
+            return false;
+        }
+        packet->RemoveHeader(nack);
+        if (nack.IsTruncated())
+        {
+            NS_LOG_WARN("Dropped a NACK with a bad word count from " << InetSocketAddress::ConvertFrom(from).GetIpv4());
+            return false;
+        }
+        return true;
+    }
+
+    void
+    VideoStreamServer::CheckLiveness(uint32_t slot)
+    {
+        NS_LOG_FUNCTION(this << slot);
+        ClientInfo *client = &m_clientTable[slot];
+        // 패킷마다 이벤트를 다시 잡지 않고, 만료될 때 마지막 수신 시각을 보고 남은 시간만큼 미룬다
+        Time idle = Simulator::Now() - client->m_lastHeard;
+        if (idle >= m_clientTimeout)
+        {
+            RemoveClient(slot, true);
+            return;
+        }
+        client->m_livenessEvent = Simulator::Schedule(m_clientTimeout - idle, &VideoStreamServer::CheckLiveness, this, slot);
+    }
+
+    void
+    VideoStreamServer::RemoveClient(uint32_t slot, bool timedOut)
+    {
+        NS_LOG_FUNCTION(this << slot << timedOut);
+        ClientInfo *client = &m_clientTable[slot];
+        NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s server removed " << InetSocketAddress::ConvertFrom(client->m_address).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(client->m_address).GetPort() << (timedOut ? " after a timeout" : " after a bye"));
+        Simulator::Cancel(client->m_sendEvent);
+        Simulator::Cancel(client->m_pacingEvent);
+        Simulator::Cancel(client->m_livenessEvent);
+        m_clientRemovedTrace(client->m_address, timedOut);
+        m_clients.erase(GetClientKey(client->m_address));
+        m_activeClients = m_clients.size();
+        UpdateTraceCache();
+        // 슬롯은 비워 두었다가 다음 클라이언트가 재사용하므로 테이블이 흩어지지 않는다
+        *client = ClientInfo();
+        m_nextSend[slot] = Time::Max();
+        m_freeSlots.push_back(slot);
+    }
+
+    uint64_t
+    VideoStreamServer::GetClientKey(const Address &address)
+    {
+        InetSocketAddress inet = InetSocketAddress::ConvertFrom(address);
+        return (static_cast<uint64_t>(inet.GetIpv4().Get()) << 16) | inet.GetPort();
+    }
+
+    uint64_t
+    VideoStreamServer::GetGroupKey(void) const
+    {
+        return GetClientKey(InetSocketAddress(m_multicastGroup, m_multicastPort));
+    }
+
+    VideoStreamServer::ClientInfo *
+    VideoStreamServer::AddClient(uint64_t key, const Address &address)
+    {
+        NS_LOG_FUNCTION(this << key);
+
+        uint32_t slot;
+        if (!m_freeSlots.empty())
+        {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            slot = m_clientTable.size();
+            m_clientTable.emplace_back();
+            m_nextSend.push_back(Time::Max());
+        }
+        ClientInfo *newClient = &m_clientTable[slot];
+        newClient->m_sent = 0;
+        newClient->m_nextSeqNum = 0;
+        newClient->m_frameEnd = 0;
+        newClient->m_tokens = m_pacingBurst;
+        newClient->m_lastRefill = Simulator::Now();
+        newClient->m_videoLevel = m_abr.GetAlgorithm() == VideoStreamAbr::ABR_NONE ? MAX_VIDEO_LEVEL : m_initialVideoLevel;
+        newClient->m_address = address;
+        newClient->m_fastStart = m_fastStartFrames > 0;
+        if (!m_ccType.empty())
+        {
+            ObjectFactory factory;
+            factory.SetTypeId(m_ccType);
+            newClient->m_cc = factory.Create<VideoStreamCongestionControl>();
+            newClient->m_cc->Init(DataRate(GetLevelBitrate(newClient->m_videoLevel)), m_maxPacketSize);
+        }
+        newClient->m_lastHeard = Simulator::Now();
+        m_clients.emplace(key, slot);
+        m_activeClients = m_clients.size();
+        UpdateTraceCache();
+        ScheduleSend(slot, Simulator::Now());
+        if (m_clientTimeout.IsStrictlyPositive())
+        {
+            newClient->m_livenessEvent = Simulator::Schedule(m_clientTimeout, &VideoStreamServer::CheckLiveness, this, slot);
+        }
+        return newClient;
+    }
+
     // get next sequence number
     uint32_t
-    VideoStreamServer::GetSeqNum(void)
+    VideoStreamServer::GetSeqNum(ClientInfo *client)
     {
         uint32_t seqNum;
-        if (m_sendQueueFront != m_sendQueueBack)
+        PruneRetransQueue(client);
+        if (!client->m_parityQueue.empty())
         {
-            seqNum = m_sendQueue[m_sendQueueFront++];
-            if (m_sendQueueFront == m_sendQueueSize)
-            {
-                m_sendQueueFront = 0;
-            }
+            seqNum = client->m_parityQueue.front();
+            client->m_parityQueue.pop_front();
+        }
+        else if (IsRetransNext(client))
+        {
+            seqNum = client->m_retransQueue.top().m_seqNum;
+            client->m_retransQueue.pop();
             NS_LOG_INFO(seqNum << " Retransmission");
+            m_retransSentTrace(seqNum, client->m_address);
         }
         else
         {
-            seqNum = m_nextSeqNum++;
+            seqNum = client->m_nextSeqNum++;
+
+            uint32_t packetsPerFrame = GetPacketsPerFrame();
+            uint32_t index = seqNum % packetsPerFrame;
+            uint32_t framePackets = GetFramePackets(GetFrame(seqNum / packetsPerFrame).m_size);
+            if (index + 1 == framePackets)
+            {
+                // 프레임의 나머지 예약된 seq는 건너뛴다
+                client->m_nextSeqNum = (seqNum / packetsPerFrame + 1) * packetsPerFrame;
+            }
+
+            // 블록의 마지막 패킷이면 그 블록의 패리티 패킷을 바로 뒤에 보낸다
+            if (m_fec.IsEnabled() && m_fec.IsBlockEnd(index, framePackets))
+            {
+                uint32_t parityPerBlock = m_fec.GetParityPerBlock();
+                uint32_t firstParity = m_fec.GetBlock(index, framePackets) * parityPerBlock;
+                for (uint32_t j = 0; j < parityPerBlock; j++)
+                {
+                    client->m_parityQueue.push_back(VideoStreamFec::MakeParitySeqNum(seqNum / packetsPerFrame, firstParity + j));
+                }
+            }
         }
 
         return seqNum;
     }
 
+    uint32_t
+    VideoStreamServer::PeekSeqNum(ClientInfo *client)
+    {
+        if (!client->m_parityQueue.empty())
+        {
+            return client->m_parityQueue.front();
+        }
+        if (IsRetransNext(client))
+        {
+            return client->m_retransQueue.top().m_seqNum;
+        }
+        return client->m_nextSeqNum;
+    }
+
+    bool
+    VideoStreamServer::IsRetransNext(ClientInfo *client)
+    {
+        if (client->m_retransQueue.empty())
+        {
+            return false;
+        }
+        if (!m_framePriority || client->m_nextSeqNum >= client->m_frameEnd)
+        {
+            return true;
+        }
+        // 재전송할 프레임보다 우선순위가 높은 새 프레임이 기다리면 새 패킷을 먼저 보낸다
+        return client->m_retransQueue.top().m_priority <= GetFramePriority(client->m_nextSeqNum / GetPacketsPerFrame());
+    }
+
+    bool
+    VideoStreamServer::HasPendingPacket(ClientInfo *client)
+    {
+        PruneRetransQueue(client);
+        if (m_dropBacklog > 0)
+        {
+            // 아직 시작하지 않은 B 프레임은 밀린 패킷이 많으면 통째로 버린다
+            uint32_t packetsPerFrame = GetPacketsPerFrame();
+            while (client->m_nextSeqNum < client->m_frameEnd && client->m_nextSeqNum % packetsPerFrame == 0)
+            {
+                uint32_t frameNum = client->m_nextSeqNum / packetsPerFrame;
+                if (GetFrame(frameNum).m_type != VideoStreamFrameHeader::FRAME_B || !IsBacklogged(client))
+                {
+                    break;
+                }
+                NS_LOG_INFO("Frame " << frameNum << " dropped");
+                client->m_frameDropped[frameNum % FRAME_LEVEL_HISTORY] = true;
+                client->m_nextSeqNum += packetsPerFrame;
+                m_droppedFrames++;
+                m_frameDropTrace(frameNum, client->m_address);
+            }
+        }
+        return !client->m_parityQueue.empty() || !client->m_retransQueue.empty() || client->m_nextSeqNum < client->m_frameEnd;
+    }
+
     void
-    VideoStreamServer::AddAckSeqNum(uint32_t seqNum)
+    VideoStreamServer::PruneRetransQueue(ClientInfo *client)
     {
-        if ((m_sendQueueBack + 1) % m_sendQueueSize == m_sendQueueFront)
+        Time now = Simulator::Now();
+        while (!client->m_retransQueue.empty() && client->m_retransQueue.top().m_deadline < now)
         {
-            NS_LOG_INFO("Queue over flow");
-            // break;
+            NS_LOG_INFO(client->m_retransQueue.top().m_seqNum << " Retransmission expired");
+            client->m_retransQueue.pop();
+            m_expiredRetrans++;
         }
-        else
+    }
+
+    bool
+    VideoStreamServer::IsBacklogged(ClientInfo *client)
+    {
+        uint32_t backlog = client->m_parityQueue.size() + client->m_retransQueue.size();
+        uint32_t packetsPerFrame = GetPacketsPerFrame();
+        uint32_t seqNum = client->m_nextSeqNum;
+        while (seqNum < client->m_frameEnd && backlog <= m_dropBacklog)
+        {
+            uint32_t frameNum = seqNum / packetsPerFrame;
+            uint32_t framePackets = GetFramePackets(GetFrame(frameNum).m_size);
+            backlog += framePackets - std::min(framePackets, seqNum % packetsPerFrame);
+            seqNum = (frameNum + 1) * packetsPerFrame;
+        }
+        return backlog > m_dropBacklog;
+    }
+
+    uint8_t
+    VideoStreamServer::GetFramePriority(uint32_t frameNum) const
+    {
+        if (!m_framePriority)
+        {
+            return 0;
+        }
+        switch (GetFrame(frameNum).m_type)
+        {
+        case VideoStreamFrameHeader::FRAME_I:
+            return 0;
+        case VideoStreamFrameHeader::FRAME_P:
+            return 1;
+        default:
+            return 2;
+        }
+    }
+
+    void
+    VideoStreamServer::SendStreamInfo(const Address &to)
+    {
+        NS_LOG_FUNCTION(this << to);
+        VideoStreamInfoHeader info;
+        info.SetStride(GetPacketsPerFrame());
+        info.SetFrameCount(GetFrameCount());
+        VideoStreamFrameHeader frameHeader;
+        frameHeader.SetInfo(true);
+        frameHeader.SetTimestamp(Simulator::Now());
+        Ptr<Packet> p = Create<Packet>();
+        p->AddHeader(info);
+        p->AddHeader(frameHeader);
+        m_txTrace(p, to);
+        if (m_socket->SendTo(p, 0, to) < 0)
+        {
+            NS_LOG_INFO("Error while sending the stream info to " << InetSocketAddress::ConvertFrom(to).GetIpv4() << " port " << InetSocketAddress::ConvertFrom(to).GetPort());
+        }
+    }
+
+    void
+    VideoStreamServer::AddAckSeqNum(ClientInfo *client, const VideoStreamNackHeader &nack)
+    {
+        std::vector<uint32_t> seqNums = nack.GetSeqNums();
+        bool backlogged = m_dropBacklog > 0 && IsBacklogged(client);
+        for (uint32_t i = 0; i < seqNums.size(); i++)
+        {
+            if (client->m_retransQueue.size() >= m_sendQueueSize)
+            {
+                NS_LOG_INFO("Queue over flow");
+                break;
+            }
+            // 아직 보내지 않은 seq에 대한 요청은 무시
+            if (!IsSentSeqNum(client, seqNums[i]))
+            {
+                continue;
+            }
+            uint32_t frameNum = seqNums[i] / GetPacketsPerFrame();
+            // 밀린 패킷이 많으면 B 프레임은 재전송하지 않는다
+            if (backlogged && GetFrame(frameNum).m_type == VideoStreamFrameHeader::FRAME_B)
+            {
+                continue;
+            }
+            client->m_retransQueue.push(RetransEntry(GetFramePriority(frameNum), GetRetransDeadline(nack, seqNums[i]), seqNums[i]));
+        }
+    }
+
+    Time
+    VideoStreamServer::GetRetransDeadline(const VideoStreamNackHeader &nack, uint32_t seqNum) const
+    {
+        if (!nack.HasDeadline())
         {
-            m_sendQueue[m_sendQueueBack++] = seqNum;
-            if (m_sendQueueBack == m_sendQueueSize)
+            return Time::Max();
+        }
+        // 뒤쪽 프레임의 마감 시간은 기준 프레임에서 프레임 간격만큼씩 늦어진다
+        uint32_t packetsPerFrame = GetPacketsPerFrame();
+        int64_t frames = seqNum / packetsPerFrame - nack.GetBaseSeqNum() / packetsPerFrame;
+        return Simulator::Now() + nack.GetDeadline() + nack.GetFrameInterval() * frames;
+    }
+
+    void
+    VideoStreamServer::AggregateNack(const Address &from, const VideoStreamNackHeader &nack)
+    {
+        ClientInfo *group = &m_clientTable[m_clients.at(GetGroupKey())];
+        std::vector<uint32_t> seqNums = nack.GetSeqNums();
+        for (uint32_t i = 0; i < seqNums.size(); i++)
+        {
+            if (!IsSentSeqNum(group, seqNums[i]))
+            {
+                continue;
+            }
+            Time deadline = GetRetransDeadline(nack, seqNums[i]);
+            auto iter = m_pendingNacks.find(seqNums[i]);
+            if (iter == m_pendingNacks.end())
+            {
+                NackAggregate aggregate;
+                aggregate.m_count = 1;
+                aggregate.m_deadline = deadline;
+                aggregate.m_from = from;
+                m_pendingNacks.emplace(seqNums[i], aggregate);
+            }
+            else
+            {
+                iter->second.m_count++;
+                iter->second.m_deadline = std::min(iter->second.m_deadline, deadline);
+            }
+        }
+        if (!m_pendingNacks.empty() && !m_flushEvent.IsRunning())
+        {
+            m_flushEvent = Simulator::Schedule(m_nackAggregation, &VideoStreamServer::FlushNacks, this);
+        }
+    }
+
+    void
+    VideoStreamServer::FlushNacks(void)
+    {
+        NS_LOG_FUNCTION(this << m_pendingNacks.size());
+
+        uint32_t groupSlot = m_clients.at(GetGroupKey());
+        ClientInfo *group = &m_clientTable[groupSlot];
+        Time now = Simulator::Now();
+        for (auto iter = m_pendingNacks.begin(); iter != m_pendingNacks.end(); iter++)
+        {
+            if (iter->second.m_count >= m_multicastThreshold)
+            {
+                // 여러 수신자가 잃은 패킷은 그룹 스트림에서 한 번만 재전송
+                if (group->m_retransQueue.size() < m_sendQueueSize)
+                {
+                    group->m_retransQueue.push(RetransEntry(GetFramePriority(iter->first / GetPacketsPerFrame()), iter->second.m_deadline, iter->first));
+                    m_multicastRetrans++;
+                }
+            }
+            else if (iter->second.m_deadline < now)
             {
-                m_sendQueueBack = 0;
+                m_expiredRetrans++;
             }
+            else
+            {
+                // 한 수신자만 잃은 패킷은 그 수신자에게만 보낸다
+                SendPacket(group, iter->first, iter->second.m_from);
+                m_retransSentTrace(iter->first, iter->second.m_from);
+                m_unicastRetrans++;
+            }
+        }
+        m_pendingNacks.clear();
+
+        if (m_pacingMode != PACING_NONE && !group->m_pacingEvent.IsRunning())
+        {
+            SendPaced(groupSlot);
         }
     }
+
+    bool
+    VideoStreamServer::IsSentSeqNum(ClientInfo *client, uint32_t seqNum)
+    {
+        if (seqNum >= client->m_nextSeqNum)
+        {
+            return false;
+        }
+        uint32_t packetsPerFrame = GetPacketsPerFrame();
+        if (client->m_frameDropped[(seqNum / packetsPerFrame) % FRAME_LEVEL_HISTORY])
+        {
+            return false; // 버린 프레임의 패킷은 보낸 적이 없다
+        }
+        return seqNum % packetsPerFrame < GetFramePackets(GetFrame(seqNum / packetsPerFrame).m_size);
+    }
+
+    VideoFrameTrace::Frame
+    VideoStreamServer::GetFrame(uint32_t frameNum) const
+    {
+        if (m_trace.IsOpen())
+        {
+            return m_trace.GetFrame(frameNum);
+        }
+        VideoFrameTrace::Frame frame;
+        frame.m_size = m_frameSize;
+        frame.m_type = VideoStreamFrameHeader::FRAME_I;
+        frame.m_refDistance = 0;
+        return frame;
+    }
+
+    uint32_t
+    VideoStreamServer::GetFramePackets(uint32_t frameSize) const
+    {
+        return (frameSize + m_maxPacketSize - 1) / m_maxPacketSize;
+    }
+
+    uint32_t
+    VideoStreamServer::GetPacketsPerFrame(void) const
+    {
+        return GetFramePackets(m_maxFrameSize);
+    }
+
+    uint32_t
+    VideoStreamServer::GetFrameCount(void) const
+    {
+        return m_trace.IsOpen() ? m_trace.GetFrameCount() : 60 * 25;
+    }
+
+    void
+    VideoStreamServer::UpdateTraceCache(void)
+    {
+        if (m_trace.IsOpen())
+        {
+            // 클라이언트마다 재생 위치가 달라 캐시가 모자라면 거의 모든 GetFrame이 파일을 다시 읽는다
+            m_trace.SetCacheChunks(std::max<uint64_t>(m_traceCacheChunks, 2 * static_cast<uint64_t>(m_clients.size())));
+        }
+    }
+
+    uint32_t
+    VideoStreamServer::GetPacketSize(ClientInfo *client, uint32_t seqNum) const
+    {
+        uint32_t packetsPerFrame = GetPacketsPerFrame();
+        bool parity = VideoStreamFec::IsParitySeqNum(seqNum);
+        uint32_t frameNum = parity ? VideoStreamFec::GetParityFrame(seqNum) : seqNum / packetsPerFrame;
+        uint32_t level = client->m_frameLevels[frameNum % FRAME_LEVEL_HISTORY];
+        uint32_t frameSize = GetFrame(frameNum).m_size;
+        uint32_t framePackets = GetFramePackets(frameSize);
+        if (parity)
+        {
+            // 패리티 패킷은 블록에서 가장 큰 패킷과 같은 크기
+            return GetLevelPacketSize(frameSize, level, framePackets == 1);
+        }
+        return GetLevelPacketSize(frameSize, level, seqNum % packetsPerFrame == framePackets - 1);
+    }
+
+    uint32_t
+    VideoStreamServer::GetLevelPacketSize(uint32_t frameSize, uint32_t level, bool lastPacket) const
+    {
+        // 프레임당 패킷 수는 그대로 두고 패킷 크기를 레벨에 비례해 줄인다
+        uint32_t size = m_maxPacketSize;
+        if (lastPacket)
+        {
+            size = frameSize - (GetFramePackets(frameSize) - 1) * m_maxPacketSize;
+        }
+        return std::max<uint32_t>(1, size * level / MAX_VIDEO_LEVEL);
+    }
+
+    uint32_t
+    VideoStreamServer::GetFrameSize(uint32_t frameSize, uint32_t level) const
+    {
+        return (GetFramePackets(frameSize) - 1) * GetLevelPacketSize(frameSize, level, false) + GetLevelPacketSize(frameSize, level, true);
+    }
+
+    uint64_t
+    VideoStreamServer::GetLevelBitrate(uint32_t level) const
+    {
+        return static_cast<uint64_t>(GetFrameSize(m_frameSize, level) * 8 / m_interval.GetSeconds());
+    }
 } // namespace ns3
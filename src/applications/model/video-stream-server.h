@@ -9,14 +9,29 @@
 #include "ns3/string.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/data-rate.h"
+#include "ns3/video-frame-payload-store.h"
+#include "ns3/video-frame-trace.h"
+#include "ns3/video-stream-abr.h"
+#include "ns3/video-stream-fec.h"
+#include "ns3/video-stream-congestion-control.h"
+#include "ns3/video-stream-rtt-estimator.h"
 
 
 //#include <fstream>
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
 #include <unordered_map>
+#include <vector>
 namespace ns3 {
 
     class Socket;
     class Packet;
+    class VideoStreamNackHeader;
+    class VideoStreamReportHeader;
 
     /**
      * @brief A Video Stream Server
@@ -35,14 +50,115 @@ namespace ns3 {
 
         virtual ~VideoStreamServer();
 
+        /**
+         * @brief How the packets of a frame are spread over the frame interval.
+         */
+        enum PacingMode
+        {
+            PACING_NONE,        //!< Send the whole frame at once
+            PACING_RATE,        //!< One packet every packet-size / PacingRate
+            PACING_TOKEN_BUCKET //!< Bursts of up to PacingBurst bytes, refilled at PacingRate
+        };
+
+        /**
+         * @brief How the frames of the clients are scheduled.
+         */
+        enum SendScheduling
+        {
+            SEND_PER_CLIENT, //!< One send event per client and frame
+            SEND_BATCHED     //!< One tick per interval that sends the frames of all due clients
+        };
+
+        /**
+         * TracedCallback signature for the congestion controlled rate of a client.
+         *
+         * @param [in] client the address of the client
+         * @param [in] rate the allowed sending rate in bit/s
+         */
+        typedef void (*CongestionRateCallback)(const Address &client, uint64_t rate);
+
+        /**
+         * TracedCallback signature for the congestion window of a client.
+         *
+         * @param [in] client the address of the client
+         * @param [in] cwnd the bytes the rate allows over one round trip time
+         */
+        typedef void (*CongestionWindowCallback)(const Address &client, uint32_t cwnd);
+
+        /**
+         * TracedCallback signature for the round trip time of a client.
+         *
+         * @param [in] client the address of the client
+         * @param [in] srtt the smoothed round trip time
+         * @param [in] rttVar the round trip time variation
+         */
+        typedef void (*RttCallback)(const Address &client, Time srtt, Time rttVar);
+
+        /**
+         * TracedCallback signature for a removed client.
+         *
+         * @param [in] client the address of the client
+         * @param [in] timedOut true if the client timed out, false if it said bye
+         */
+        typedef void (*ClientRemovedCallback)(const Address &client, bool timedOut);
+
+        /**
+         * TracedCallback signature for a packet of a client's stream.
+         *
+         * @param [in] seqNum the sequence number of the packet
+         * @param [in] client the address the packet is sent to
+         */
+        typedef void (*SeqNumCallback)(uint32_t seqNum, const Address &client);
+
+        /**
+         * TracedCallback signature for a frame of a client's stream.
+         *
+         * @param [in] frameNum the frame number
+         * @param [in] client the address of the client
+         */
+        typedef void (*FrameCallback)(uint32_t frameNum, const Address &client);
+
     protected:
         virtual void DoDispose(void);
 
     private:
+        static const uint32_t FRAME_LEVEL_HISTORY = 256; //!< Frames whose video level is remembered for retransmissions
 
         virtual void StartApplication(void);
         virtual void StopApplication(void);
 
+        /**
+         * @brief A requested retransmission, ordered by frame priority, then deadline.
+         */
+        struct RetransEntry
+        {
+            RetransEntry(uint8_t priority, Time deadline, uint32_t seqNum)
+                : m_priority(priority), m_deadline(deadline), m_seqNum(seqNum)
+            {
+            }
+            bool operator>(const RetransEntry &other) const
+            {
+                if (m_priority != other.m_priority)
+                    return m_priority > other.m_priority;
+                if (m_deadline != other.m_deadline)
+                    return m_deadline > other.m_deadline;
+                return m_seqNum > other.m_seqNum;
+            }
+            uint8_t m_priority; //!< Priority of the frame, 0 is sent first
+            Time m_deadline;    //!< Playout deadline of the frame
+            uint32_t m_seqNum;  //!< Requested sequence number
+        };
+
+        /**
+         * @brief NACKs of one sequence number merged over the aggregation interval in multicast mode.
+         */
+        struct NackAggregate
+        {
+            uint32_t m_count; //!< Number of receivers that requested the sequence number
+            Time m_deadline;  //!< Earliest playout deadline among the requests
+            Address m_from;   //!< First receiver that requested it
+        };
+
         /**
          * @brief The information required for each client.
          */
@@ -50,22 +166,167 @@ namespace ns3 {
         {
             Address m_address; //!< Address
             uint32_t m_sent; //!< Counter for sent frames
-            EventId m_sendEvent; //! Send event used by the client
+            EventId m_sendEvent; //!< Send event of the client with SEND_PER_CLIENT
+            uint32_t m_nextSeqNum; //!< Next new sequence number of this client's stream
+            std::priority_queue<RetransEntry, std::vector<RetransEntry>, std::greater<RetransEntry>> m_retransQueue; //!< Sequence numbers NACKed by this client, highest priority and earliest deadline first
+            uint32_t m_frameEnd; //!< Sequence number after the last packet released for sending
+            std::deque<uint32_t> m_parityQueue; //!< Parity sequence numbers of blocks whose source packets were sent
+            EventId m_pacingEvent; //!< Next paced packet of the client
+            double m_tokens; //!< Token bucket level in bytes
+            Time m_lastRefill; //!< Last time the token bucket was refilled
+            uint32_t m_videoLevel; //!< Video level of the next frame
+            uint8_t m_frameLevels[FRAME_LEVEL_HISTORY]; //!< Video level of recent frames, indexed by frame number
+            bool m_frameDropped[FRAME_LEVEL_HISTORY]; //!< Whether recent frames were dropped, indexed by frame number
+            Ptr<VideoStreamCongestionControl> m_cc; //!< Congestion controller, null if disabled
+            VideoStreamRttEstimator m_rtt; //!< Round trip time measured with the echoed timestamps of the reports
+            bool m_fastStart; //!< Whether frames are still sent faster than the interval
+            Time m_lastHeard; //!< Arrival time of the last packet from the client
+            EventId m_livenessEvent; //!< Event to time the client out
         } ClientInfo; //! To be compatible with C language
 
         /**
-         * @brief Send a packet with specified size.
+         * @brief Send the packet with the given sequence number.
+         *
+         * The payload is taken from the shared frame payload store.
+         *
+         * @param client the client to send to
+         * @param seqNum the sequence number of the packet
+         */
+        void SendPacket(ClientInfo* client, uint32_t seqNum);
+
+        /**
+         * @brief Send a packet of a client's stream to another address.
+         *
+         * @param client the stream the packet belongs to
+         * @param seqNum the sequence number of the packet
+         * @param to the destination address
+         */
+        void SendPacket(ClientInfo* client, uint32_t seqNum, const Address &to);
+
+        /**
+         * @brief Send the constants of the stream to a client.
+         *
+         * @param to the client address
+         */
+        void SendStreamInfo(const Address &to);
+
+        /**
+         * @brief Create the state of a new stream in a free slot of the
+         * client table and start sending it.
+         *
+         * @param key the key of the stream in m_clients
+         * @param address the address the stream is sent to
+         * @return the new stream
+         */
+        ClientInfo* AddClient(uint64_t key, const Address &address);
+
+        /**
+         * @brief Time a client out if nothing arrived from it for ClientTimeout,
+         * otherwise check again when that much time has passed since its last packet.
+         *
+         * @param slot the slot of the client in the client table
+         */
+        void CheckLiveness(uint32_t slot);
+
+        /**
+         * @brief Stop the stream of a client and free its slot.
+         *
+         * @param slot the slot of the client in the client table
+         * @param timedOut true if the client timed out, false if it said bye
+         */
+        void RemoveClient(uint32_t slot, bool timedOut);
+
+        /**
+         * @brief Get the key of a client in m_clients.
+         *
+         * Clients are told apart by address and port, so several clients
+         * behind one address get their own stream.
+         *
+         * @param address the InetSocketAddress of the client
+         * @return the ipv4 address in the upper and the port in the lower 16 bits
+         */
+        static uint64_t GetClientKey(const Address &address);
+
+        /**
+         * @return the key of the multicast group stream in m_clients
+         */
+        uint64_t GetGroupKey(void) const;
+
+        /**
+         * @brief Send the video frame to a client and schedule its next one.
+         *
+         * @param slot the slot of the client in the client table
+         */
+        void Send(uint32_t slot);
+
+        /**
+         * @brief Send the frames of all clients that are due, then schedule
+         * the tick for the earliest next frame.
+         *
+         * The due clients are popped from m_sendQueue, so a tick costs
+         * O(k log n) for k due clients instead of a scan of every slot.
+         * Only used with SEND_BATCHED.
+         */
+        void SendTick(void);
+
+        /**
+         * @brief Schedule the next frame of a client.
+         *
+         * With SEND_BATCHED the time is stored in m_nextSend and pushed to
+         * m_sendQueue, and the tick is moved earlier if it would come too late.
+         *
+         * @param slot the slot of the client in the client table
+         * @param when the absolute time of the frame
+         */
+        void ScheduleSend(uint32_t slot, Time when);
+
+        /**
+         * @param earliest the earliest time the tick may be at
+         * @return the first multiple of the interval since the start of the
+         * server at or after earliest
+         */
+        Time GetTickTime(Time earliest) const;
+
+        /**
+         * @brief Send the released packets of a client at the pacing rate.
+         *
+         * @param slot the slot of the client in the client table
+         */
+        void SendPaced(uint32_t slot);
+
+        /**
+         * @param client the client to send to
+         * @return the rate packets are paced at
+         */
+        DataRate GetPacingRate(ClientInfo* client) const;
+
+        /**
+         * @brief Get how many times faster than the interval a client in
+         * fast start is sent to.
+         *
+         * The speedup is bounded so the video rate stays below
+         * FastStartMaxRate and the congestion controlled rate, but never
+         * below the playback rate.
+         *
+         * @param client the client
+         * @return the speedup, at least 1
+         */
+        double GetFastStartSpeedup(ClientInfo* client) const;
+
+        /**
+         * @brief Return a client to one frame per interval.
          *
-         * @param packetSize the number of bytes for the packet to be sent
+         * @param client the client
          */
-        void SendPacket(ClientInfo* client, uint32_t packetSize);
+        void EndFastStart(ClientInfo* client);
 
         /**
-         * @brief Send the video frame to the given ipv4 address.
+         * @brief Select the video level of a client from its report.
          *
-         * @param ipAddress ipv4 address
+         * @param client the client that sent the report
+         * @param report the report
          */
-        void Send(uint32_t ipAddress);
+        void HandleReport(ClientInfo* client, const VideoStreamReportHeader &report);
 
         /**
          * @brief Handle a packet reception.
@@ -76,11 +337,185 @@ namespace ns3 {
          */
         void HandleRead(Ptr<Socket> socket);
 
-        uint32_t GetSeqNum(void);
+        /**
+         * @brief Remove the NACK that follows the control header of a packet.
+         *
+         * Packets shorter than the fixed part of the NACK, or whose word
+         * count exceeds MAX_WORDS or the bytes left, are dropped.
+         *
+         * @param packet the packet, after its control header
+         * @param nack set to the NACK
+         * @param from the sender, for the log
+         * @return false if the packet was dropped
+         */
+        bool RemoveNack(Ptr<Packet> packet, VideoStreamNackHeader &nack, const Address &from);
+
+        /**
+         * @brief Get the next sequence number to send to a client.
+         *
+         * Parity packets of a completed block go first, then retransmissions
+         * requested by the client, then new packets. With FramePriority a
+         * retransmission waits for new packets of a frame with a higher
+         * priority.
+         *
+         * @param client the client to send to
+         * @return the sequence number
+         */
+        uint32_t GetSeqNum(ClientInfo* client);
+
+        /**
+         * @brief Get the sequence number GetSeqNum would return, without taking it.
+         *
+         * @param client the client to send to
+         * @return the sequence number
+         */
+        uint32_t PeekSeqNum(ClientInfo* client);
+
+        /**
+         * @param client the client to send to
+         * @return true if the next packet is a retransmission rather than a new packet
+         */
+        bool IsRetransNext(ClientInfo* client);
+
+        /**
+         * @brief Check whether a parity, retransmitted or released packet is waiting.
+         *
+         * Released B frames that have not started yet are dropped here while
+         * the backlog of the client is above DropBacklog.
+         *
+         * @param client the client to send to
+         * @return true if a packet is waiting
+         */
+        bool HasPendingPacket(ClientInfo* client);
+
+        /**
+         * @param client the client
+         * @return true if more than DropBacklog packets are waiting to be sent to the client
+         */
+        bool IsBacklogged(ClientInfo* client);
+
+        /**
+         * @brief Get the send priority of a frame.
+         *
+         * @param frameNum the frame number
+         * @return 0 for I, 1 for P and 2 for B frames, 0 for all frames without FramePriority
+         */
+        uint8_t GetFramePriority(uint32_t frameNum) const;
+
+        /**
+         * @brief Drop requested retransmissions whose frame deadline has passed.
+         *
+         * @param client the client
+         */
+        void PruneRetransQueue(ClientInfo* client);
+
+        /**
+         * @brief Expand a NACK into the retransmission queue of a client.
+         *
+         * @param client the client that sent the NACK
+         * @param nack the coalesced retransmission request of the client
+         */
+        void AddAckSeqNum(ClientInfo* client, const VideoStreamNackHeader &nack);
 
-        void AddAckSeqNum(uint32_t seqNum);
+        /**
+         * @brief Get the playout deadline of a sequence number requested by a NACK.
+         *
+         * @param nack the NACK
+         * @param seqNum one of the sequence numbers of the NACK
+         * @return the absolute deadline, Time::Max() if the NACK has none
+         */
+        Time GetRetransDeadline(const VideoStreamNackHeader &nack, uint32_t seqNum) const;
+
+        /**
+         * @brief Merge a receiver's NACK into the pending requests of the multicast group.
+         *
+         * @param from the receiver that sent the NACK
+         * @param nack the NACK
+         */
+        void AggregateNack(const Address &from, const VideoStreamNackHeader &nack);
+
+        /**
+         * @brief Retransmit the merged NACKs: by multicast if at least
+         * MulticastRetransThreshold receivers lost the packet, by unicast otherwise.
+         */
+        void FlushNacks(void);
+
+        /**
+         * @brief Check that a requested sequence number was sent to a client.
+         *
+         * @param client the client
+         * @param seqNum the requested sequence number
+         * @return false if it was not sent yet or lies past the last packet of its frame
+         */
+        bool IsSentSeqNum(ClientInfo* client, uint32_t seqNum);
+
+        /**
+         * @brief Get the size and type of a frame at MAX_VIDEO_LEVEL.
+         *
+         * @param frameNum the frame number
+         * @return the frame from the video trace, or the fixed frame without a trace
+         */
+        VideoFrameTrace::Frame GetFrame(uint32_t frameNum) const;
+
+        /**
+         * @param frameSize the number of bytes of the frame at MAX_VIDEO_LEVEL
+         * @return the number of packets of the frame
+         */
+        uint32_t GetFramePackets(uint32_t frameSize) const;
+
+        /**
+         * @brief Get the payload size of the packet with the given sequence number.
+         *
+         * @param client the client the packet is sent to
+         * @param seqNum the sequence number
+         * @return the number of bytes
+         */
+        uint32_t GetPacketSize(ClientInfo* client, uint32_t seqNum) const;
+
+        /**
+         * @brief Get the payload size of a packet of a frame at the given video level.
+         *
+         * @param frameSize the number of bytes of the frame at MAX_VIDEO_LEVEL
+         * @param level the video level
+         * @param lastPacket whether the packet is the last one of the frame
+         * @return the number of bytes
+         */
+        uint32_t GetLevelPacketSize(uint32_t frameSize, uint32_t level, bool lastPacket) const;
+
+        /**
+         * @param frameSize the number of bytes of the frame at MAX_VIDEO_LEVEL
+         * @param level the video level
+         * @return the number of bytes of the frame at the given level
+         */
+        uint32_t GetFrameSize(uint32_t frameSize, uint32_t level) const;
+
+        /**
+         * @param level the video level
+         * @return the bitrate of the video at the given level in bit/s
+         */
+        uint64_t GetLevelBitrate(uint32_t level) const;
+
+        /**
+         * @return the number of sequence numbers reserved for each frame, the packets of the largest frame
+         */
+        uint32_t GetPacketsPerFrame(void) const;
+
+        /**
+         * @return the number of frames of the stream
+         */
+        uint32_t GetFrameCount(void) const;
+
+        /**
+         * @brief Size the trace cache for the active clients.
+         *
+         * Every client reads its own position of the trace and may reach
+         * back into the previous chunk, so the cache keeps two chunks per
+         * client, and at least TraceCacheChunks.
+         */
+        void UpdateTraceCache(void);
 
         Time m_interval; //!< Packet inter-send time
+        SendScheduling m_sendScheduling; //!< Whether frames are sent by per-client events or one tick
         uint32_t m_maxPacketSize; //!< Maximum size of the packet to be sent
         Ptr<Socket> m_socket; //!< Socket
 
@@ -88,14 +523,75 @@ namespace ns3 {
         Address m_local; //!< Local multicast address
 
         uint32_t m_packetNum;
-        uint32_t m_nextSeqNum;
-        uint32_t m_waitingSeqNum;
-        uint32_t* m_sendQueue; // send buffer
-        uint32_t m_sendQueueSize;
-        uint32_t m_sendQueueFront;
-        uint32_t m_sendQueueBack;
-
-        std::unordered_map<uint32_t, ClientInfo*> m_clients; //!< Information saved for each client
+        uint32_t m_frameSize; //!< Mean bytes of a frame at MAX_VIDEO_LEVEL
+        uint32_t m_maxFrameSize; //!< Bytes of the largest frame at MAX_VIDEO_LEVEL
+        std::string m_traceFile; //!< Video trace with the frame sizes, empty for fixed frames
+        mutable VideoFrameTrace m_trace; //!< Frames of the video trace, read on demand
+        uint32_t m_traceChunkFrames; //!< Frames of the trace read at once
+        uint32_t m_traceCacheChunks; //!< Smallest number of trace chunks kept in memory
+        uint32_t m_sendQueueSize; //!< Maximum retransmission queue length of each client
+        bool m_framePriority; //!< Whether I frames are sent and retransmitted before P and B frames
+        uint32_t m_dropBacklog; //!< Waiting packets above which B frames are dropped, 0 to never drop
+        Time m_clientTimeout; //!< Silence after which a unicast client is removed, 0 to wait for its bye
+        uint32_t m_fastStartFrames; //!< Initial frames sent faster than the interval, 0 to disable
+        double m_fastStartSpeedup; //!< Speedup of the frame rate during fast start
+        DataRate m_fastStartMaxRate; //!< Largest video rate during fast start, 0 for no bound
+        uint32_t m_fastStartPrimed; //!< Reported buffered frames that end fast start, 0 to ignore reports
+
+        PacingMode m_pacingMode; //!< How packets are spread over the interval
+        DataRate m_pacingRate; //!< Pacing rate, 0 derives it from the frame size and interval
+        uint32_t m_pacingBurst; //!< Token bucket depth in bytes
+
+        VideoStreamAbr::Algorithm m_abrAlgorithm; //!< How video levels are selected
+        uint32_t m_abrReservoir; //!< Buffered frames below which the lowest level is used
+        uint32_t m_abrCushion; //!< Buffered frames above the reservoir to reach the highest level
+        double m_abrSafety; //!< Fraction of the reported throughput the video may use
+        uint32_t m_initialVideoLevel; //!< Video level of a new client when ABR is enabled
+        VideoStreamAbr m_abr; //!< Adaptive bitrate logic
+
+        std::string m_ccType; //!< Type name of the congestion controller, empty to disable
+
+        VideoFramePayloadStore::PayloadMode m_payloadMode; //!< How packet payloads are built
+        uint32_t m_payloadCacheFrames; //!< Number of frame payloads kept in the store
+        VideoFramePayloadStore m_payloadStore; //!< Frame payloads shared by all clients
+
+        VideoStreamFec::FecMode m_fecMode; //!< Forward error correction code
+        uint32_t m_fecBlockSize; //!< Source packets per FEC block, 0 for one block per frame
+        uint32_t m_fecParity; //!< Reed-Solomon parity packets per block
+        VideoStreamFec m_fec; //!< FEC block layout
+
+        Ipv4Address m_multicastGroup; //!< Group the stream is sent to, multicast mode if it is a multicast address
+        uint16_t m_multicastPort; //!< Port of the receivers in the group
+        Time m_nackAggregation; //!< Interval NACKs of the group are merged over
+        uint32_t m_multicastThreshold; //!< Receivers that must lose a packet for a multicast retransmission
+        std::map<uint32_t, NackAggregate> m_pendingNacks; //!< Merged NACKs of the group by sequence number
+        EventId m_flushEvent; //!< Event to retransmit the merged NACKs
+
+        TracedValue<uint64_t> m_expiredRetrans; //!< Retransmissions skipped because their frame was already played
+        TracedValue<uint64_t> m_multicastRetrans; //!< Retransmissions sent once to the whole group
+        TracedValue<uint64_t> m_unicastRetrans; //!< Retransmissions of the group sent to a single receiver
+        TracedValue<uint64_t> m_droppedFrames; //!< Frames dropped because the backlog of their client was too long
+        TracedCallback<uint32_t, const Address &> m_frameDropTrace; //!< Dropped frames, with the client
+        TracedValue<uint32_t> m_activeClients; //!< Streams with state on the server
+        TracedCallback<const Address &, bool> m_clientRemovedTrace; //!< Clients removed, with whether they timed out
+        TracedCallback<uint32_t, const Address &> m_fastStartEndTrace; //!< Clients leaving fast start, with the frames sent
+        TracedCallback<Ptr<const Packet>, const Address &> m_txTrace; //!< Packets sent, with the destination
+        TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace; //!< Packets received, with the source
+        TracedCallback<uint32_t, const Address &> m_retransSentTrace; //!< Retransmitted sequence numbers
+        TracedCallback<const Address &, uint64_t> m_ccRateTrace; //!< Congestion controlled rate after each report
+        TracedCallback<const Address &, uint32_t> m_cwndTrace; //!< Congestion window after each report
+        TracedCallback<const Address &, Time, Time> m_rttTrace; //!< Round trip time after each report with an echoed timestamp
+
+        std::unordered_map<uint64_t, uint32_t> m_clients; //!< Slot of each client in the client table, by address and port
+        std::deque<ClientInfo> m_clientTable; //!< Information saved for each client, by slot; a deque keeps the entries in place as it grows
+        std::vector<Time> m_nextSend; //!< Time the next frame of each slot is due with SEND_BATCHED, Time::Max() if none
+        /// Min-heap of (send time, slot); entries that no longer match m_nextSend are stale and skipped
+        typedef std::priority_queue<std::pair<Time, uint32_t>, std::vector<std::pair<Time, uint32_t>>, std::greater<std::pair<Time, uint32_t>>> SendQueue;
+        SendQueue m_sendQueue; //!< Pending batched sends, earliest first
+        std::vector<uint32_t> m_freeSlots; //!< Slots of removed clients, reused before the table grows
+        EventId m_tickEvent; //!< Next batched send tick
+        Time m_nextTick; //!< Time of m_tickEvent, Time::Max() if none is scheduled
+        Time m_tickStart; //!< Start of the server, the origin of the tick grid
     };
 
 } // namespace ns3
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "video-stream-timer-wheel.h"
+
+namespace ns3
+{
+
+    NS_LOG_COMPONENT_DEFINE("VideoStreamTimerWheel");
+
+    VideoStreamTimerWheel::VideoStreamTimerWheel()
+        : m_granularity(MilliSeconds(1)),
+          m_entries(0),
+          m_generation(0),
+          m_eventTick(0)
+    {
+        m_slots.resize(1);
+    }
+
+    VideoStreamTimerWheel::~VideoStreamTimerWheel()
+    {
+        Simulator::Cancel(m_event);
+    }
+
+    void
+    VideoStreamTimerWheel::Setup(Time granularity, uint32_t slots, ExpireCallback expire)
+    {
+        NS_LOG_FUNCTION(this << granularity << slots);
+        NS_ASSERT(granularity.IsStrictlyPositive() && slots > 0);
+        Clear();
+        m_granularity = granularity;
+        m_slots.assign(slots, std::vector<Entry>());
+        m_start = Simulator::Now();
+        m_expire = expire;
+    }
+
+    uint64_t
+    VideoStreamTimerWheel::GetCurrentTick(void) const
+    {
+        return (Simulator::Now() - m_start).GetTimeStep() / m_granularity.GetTimeStep();
+    }
+
+    void
+    VideoStreamTimerWheel::Schedule(uint32_t id, Time delay)
+    {
+        int64_t ticks = (delay.GetTimeStep() + m_granularity.GetTimeStep() - 1) / m_granularity.GetTimeStep();
+        Entry entry;
+        entry.m_id = id;
+        entry.m_generation = ++m_generation;
+        entry.m_tick = GetCurrentTick() + std::max<int64_t>(ticks, 1);
+        m_pending[id] = entry.m_generation;
+        m_slots[entry.m_tick % m_slots.size()].push_back(entry);
+        m_entries++;
+
+        if (!m_event.IsRunning() || entry.m_tick < m_eventTick)
+        {
+            Simulator::Cancel(m_event);
+            m_eventTick = entry.m_tick;
+            m_event = Simulator::Schedule(m_start + TimeStep(m_eventTick * m_granularity.GetTimeStep()) - Simulator::Now(),
+                                          &VideoStreamTimerWheel::Tick, this);
+        }
+    }
+
+    void
+    VideoStreamTimerWheel::Cancel(uint32_t id)
+    {
+        m_pending.erase(id);
+        if (m_pending.empty())
+        {
+            // 남은 항목은 모두 취소된 것이므로 한 번에 비운다
+            Clear();
+        }
+    }
+
+    bool
+    VideoStreamTimerWheel::IsPending(uint32_t id) const
+    {
+        return m_pending.find(id) != m_pending.end();
+    }
+
+    uint32_t
+    VideoStreamTimerWheel::GetSize(void) const
+    {
+        return m_pending.size();
+    }
+
+    void
+    VideoStreamTimerWheel::Clear(void)
+    {
+        Simulator::Cancel(m_event);
+        if (m_entries > 0)
+        {
+            for (uint32_t s = 0; s < m_slots.size(); s++)
+            {
+                m_slots[s].clear();
+            }
+        }
+        m_entries = 0;
+        m_pending.clear();
+    }
+
+    void
+    VideoStreamTimerWheel::Arm(void)
+    {
+        if (m_entries == 0)
+        {
+            return;
+        }
+        // 한 바퀴 안에서 비어 있지 않은 첫 슬롯까지 건너뛴다
+        uint64_t now = GetCurrentTick();
+        for (uint64_t tick = now + 1; tick <= now + m_slots.size(); tick++)
+        {
+            if (!m_slots[tick % m_slots.size()].empty())
+            {
+                m_eventTick = tick;
+                m_event = Simulator::Schedule(m_start + TimeStep(tick * m_granularity.GetTimeStep()) - Simulator::Now(),
+                                              &VideoStreamTimerWheel::Tick, this);
+                return;
+            }
+        }
+    }
+
+    void
+    VideoStreamTimerWheel::Tick(void)
+    {
+        uint64_t now = GetCurrentTick();
+        std::vector<Entry> &slot = m_slots[now % m_slots.size()];
+
+        // 콜백이 새 타이머를 같은 슬롯에 넣을 수 있으므로 만료된 id를 먼저 모은다
+        std::vector<uint32_t> expired;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < slot.size(); i++)
+        {
+            const Entry &entry = slot[i];
+            std::unordered_map<uint32_t, uint32_t>::iterator it = m_pending.find(entry.m_id);
+            if (it == m_pending.end() || it->second != entry.m_generation)
+            {
+                continue; // 취소되었거나 다시 예약된 타이머
+            }
+            if (entry.m_tick > now)
+            {
+                slot[kept++] = entry; // 다음 바퀴에 만료된다
+                continue;
+            }
+            m_pending.erase(it);
+            expired.push_back(entry.m_id);
+        }
+        m_entries -= slot.size() - kept;
+        slot.resize(kept);
+
+        for (uint32_t i = 0; i < expired.size(); i++)
+        {
+            m_expire(expired[i]);
+        }
+        // 콜백이 예약한 타이머보다 먼저 만료되는 슬롯이 있을 수 있으므로 다시 찾는다
+        Simulator::Cancel(m_event);
+        Arm();
+    }
+
+} // namespace ns3
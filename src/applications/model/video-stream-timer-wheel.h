@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef VIDEO_STREAM_TIMER_WHEEL_H
+#define VIDEO_STREAM_TIMER_WHEEL_H
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * @brief Hashed timer wheel for many short timers of one application.
+     *
+     * Timers are identified by a 32-bit id and rounded up to the next tick
+     * of the wheel. A timer due at tick t lives in slot t % slots; timers
+     * further away than one turn of the wheel stay in their slot until
+     * their tick comes. Only one simulator event is scheduled at a time, at
+     * the next tick whose slot holds a timer, so thousands of timers cost
+     * no more events than the ticks they expire on.
+     *
+     * Cancelling is O(1): the timer is forgotten and its entry is dropped
+     * when its slot is visited.
+     */
+    class VideoStreamTimerWheel
+    {
+    public:
+        /**
+         * Callback signature for an expired timer.
+         *
+         * @param [in] id the id of the timer
+         */
+        typedef Callback<void, uint32_t> ExpireCallback;
+
+        VideoStreamTimerWheel();
+        ~VideoStreamTimerWheel();
+
+        /**
+         * @brief Configure the wheel and drop every timer.
+         *
+         * @param granularity the duration of one tick
+         * @param slots the number of slots of the wheel
+         * @param expire called with the id of every expired timer
+         */
+        void Setup(Time granularity, uint32_t slots, ExpireCallback expire);
+
+        /**
+         * @brief Start a timer, replacing a pending one with the same id.
+         *
+         * @param id the id of the timer
+         * @param delay the time until the timer expires, rounded up to a tick
+         */
+        void Schedule(uint32_t id, Time delay);
+
+        /**
+         * @brief Stop a timer.
+         *
+         * @param id the id of the timer, ignored if not pending
+         */
+        void Cancel(uint32_t id);
+
+        /**
+         * @param id the id of the timer
+         * @return true if the timer is pending
+         */
+        bool IsPending(uint32_t id) const;
+
+        /**
+         * @return the number of pending timers
+         */
+        uint32_t GetSize(void) const;
+
+        /**
+         * @brief Stop every timer.
+         */
+        void Clear(void);
+
+    private:
+        struct Entry
+        {
+            uint32_t m_id;         //!< Timer id
+            uint32_t m_generation; //!< Generation of the timer, stale if it differs from m_pending
+            uint64_t m_tick;       //!< Tick the timer expires on
+        };
+
+        /**
+         * @return the tick of the current simulation time, rounded down
+         */
+        uint64_t GetCurrentTick(void) const;
+
+        /**
+         * @brief Schedule the wheel event at the next tick whose slot is not empty.
+         */
+        void Arm(void);
+
+        /**
+         * @brief Expire the timers of the current tick.
+         */
+        void Tick(void);
+
+        Time m_granularity;
+        Time m_start;                  //!< Time of tick 0
+        std::vector<std::vector<Entry>> m_slots;
+        uint32_t m_entries;            //!< Entries in the slots, including cancelled ones
+        std::unordered_map<uint32_t, uint32_t> m_pending; //!< Timer id -> generation
+        uint32_t m_generation;         //!< Generation of the last started timer
+        uint64_t m_eventTick;          //!< Tick of m_event
+        EventId m_event;               //!< The only scheduled event of the wheel
+        ExpireCallback m_expire;
+    };
+
+} // namespace ns3
+
+#endif /* VIDEO_STREAM_TIMER_WHEEL_H */